@@ -3,6 +3,9 @@
 #endif
 #include "app.hpp"
 #include <vulkan/vulkan_raii.hpp>
+#include <linux/input-event-codes.h>
+#include <cstdlib>
+#include <string_view>
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 
@@ -10,32 +13,98 @@ App::App() : m_window(800, 600), m_renderer(){};
 
 void App::init() {
     std::println("init app!");
+	// Worker per core; the main thread is slot 0 and helps whenever it waits on a job
+	Zeta::Jobs::get().init();
 	m_window.set_resize_callback([this](uint32_t w, uint32_t h) {
-        this->m_eventBus.push(Zeta::ResizeEvent{w, h});
+        this->m_eventBus.push(Zeta::ResizeEvent{w, h, Zeta::event_clock_ns()});
     });
-	m_window.set_key_callback([this](uint32_t key, bool pressed) {
-		this->m_eventBus.push(Zeta::KeyEvent{key, pressed});
+	m_window.set_key_callback([this](const Zeta::KeyEvent& ev) {
+		this->m_eventBus.push(ev);
 	});
-	m_renderer.init(m_window.get_display(), m_window.get_surface(), m_window.m_width, m_window.m_height);
+	m_window.set_pointer_callback([this](const Zeta::CoreEvent& ev) {
+		std::visit([this](const auto& e) { this->m_eventBus.push(e); }, ev);
+	});
+	// ZETA_RENDER_SCALE=0.5 renders a quarter of the pixels and lets the compositor upscale
+	if (const char* scale = std::getenv("ZETA_RENDER_SCALE")) m_window.set_render_scale(std::strtof(scale, nullptr));
+	// Buffer size once the first configure arrived, the output mode before that
+	uint32_t width = m_window.m_physicalWidth ? m_window.m_physicalWidth : m_window.m_width;
+	uint32_t height = m_window.m_physicalHeight ? m_window.m_physicalHeight : m_window.m_height;
+	// ZETA_SWAPCHAIN=low-latency|throughput|power-saver
+	if (const char* profile = std::getenv("ZETA_SWAPCHAIN")) {
+		if (auto parsed = Zeta::parse_swapchain_profile(profile)) m_renderer.set_swapchain_profile(*parsed);
+		else std::println("unknown swapchain profile '{}', keeping {}", profile, Zeta::profile_name(m_renderer.swapchain_profile()));
+	}
+	// ZETA_DRS_MS=8 holds the GPU frame at 8 ms by varying the main pass resolution
+	if (const char* drs = std::getenv("ZETA_DRS_MS")) m_renderer.set_dynamic_resolution(std::strtod(drs, nullptr));
+	m_renderer.init(m_window.get_display(), m_window.get_surface(), width, height);
+	// Keyboard and pointer input is read on its own thread straight into the (thread-safe) event bus.
+	// ZETA_INPUT_THREAD=0 keeps it on the frame loop's poll_events() instead.
+	const char* inputThread = std::getenv("ZETA_INPUT_THREAD");
+	if (!inputThread || std::string_view(inputThread) != "0") m_window.start_input_thread();
+	const char* throttle = std::getenv("ZETA_FRAME_THROTTLE");
+	m_throttleFrames = !throttle || std::string_view(throttle) != "0";
+	// Scrape a running instance with: socat - UNIX-CONNECT:$XDG_RUNTIME_DIR/zeta-<pid>.sock
+	Zeta::Metrics::get().serve();
 };
+void App::poll_window(int timeoutMs) {
+	if (!m_window.poll_events(timeoutMs)) {
+		std::println("wayland connection lost");
+		m_running = false;
+	}
+}
+
+// Take everything the Wayland callbacks (and any worker threads) queued this frame in one pass,
+// collapsing resize storms and repeated key states into one event per type.
+// The next drawn frame is tagged with the earliest input consumed, for input-to-present latency.
+void App::dispatch_events() {
+    ZETA_ZONE("dispatch_events");
+    m_eventQueueDepth.set(static_cast<double>(m_eventBus.size()));
+    m_eventBus.drain_coalesced([this](const AppEvent& e) {
+        if (uint64_t t = Zeta::input_time(e)) {
+            m_frameInputNs = Zeta::earliest_time(m_frameInputNs, t);
+            ++m_frameInputCount;
+        }
+        std::visit(overloaded {
+            [this](const Zeta::QuitEvent&) { m_running = false; },
+            [this](const Zeta::ResizeEvent& ev) { m_renderer.handle_resize(ev.w, ev.h); },
+            [this](const Zeta::KeyEvent& ev) { 
+                if (ev.key == KEY_ESC) m_running = false; 
+                // P cycles the swapchain profile
+                if (ev.pressed && ev.key == KEY_P) {
+                    auto next = static_cast<Zeta::SwapchainProfile>((static_cast<int>(m_renderer.swapchain_profile()) + 1) % 3);
+                    m_renderer.set_swapchain_profile(next);
+                }
+                // -/= step the render scale; the swapchain follows through a ResizeEvent
+                if (ev.pressed && (ev.key == KEY_MINUS || ev.key == KEY_EQUAL)) {
+                    m_window.set_render_scale(m_window.render_scale() + (ev.key == KEY_MINUS ? -0.125f : 0.125f));
+                    std::println("render scale {:.3f} ({}x{})", m_window.render_scale(), m_window.m_physicalWidth, m_window.m_physicalHeight);
+                }
+            },
+            [](const auto&) {}
+        }, e);
+    });
+}
+
 void App::run() {
+    ZETA_THREAD_NAME("main");
 
     while (m_running == true) {
-
+		// Hidden, occluded or suspended: the compositor has not asked for a frame (and may never),
+		// so sleep on the socket until it does instead of rendering frames nobody sees.
+		// Events and finished coroutines are still serviced every wake-up.
+		if (m_throttleFrames && (m_window.frame_pending() || m_window.suspended())) {
+			m_throttledWaits.add();
+			poll_window(IDLE_POLL_MS);
+			dispatch_events();
+			Zeta::TaskScheduler::get().run_main_queue();
+			continue;
+		}
 
 		m_fps.begin();
 		//std::this_thread::sleep_for(std::chrono::milliseconds(16));
-		m_window.poll_events();
-		Zeta::Event e;
-        while (auto e = m_eventBus.poll()) {
-            std::visit(overloaded {
-                [this](const QuitEvent&) { m_running = false; },
-                [this](const ResizeEvent& ev) { m_renderer.handle_resize(ev.w, ev.h); },
-                [this](const KeyEvent& ev) { 
-                    if (ev.key == KEY_ESC) m_running = false; 
-                }
-            }, *e);
-        }
+		// Never blocks: the frame loop must not wait on the compositor
+		poll_window(0);
+		dispatch_events();
         // 2. Handle Resizing Handshake
 		// if (m_window.m_resize_pending) {
 		// 	m_window.acknowledge_resize(); // Replaces direct access to private members
@@ -43,13 +112,55 @@ void App::run() {
 		// 	m_window.m_resize_pending = false;
 		// }
 
+        // Continue coroutines whose GPU waits or file reads completed since last frame
+        Zeta::TaskScheduler::get().run_main_queue();
+
         // 3. Render
-        m_renderer.draw_frame();
+        // Both ride on the commit vkQueuePresentKHR makes for this frame
+        if (m_throttleFrames) m_window.request_frame();
+        m_frameInputs.set(static_cast<double>(m_frameInputCount));
+        m_window.track_frame(m_renderer.frame_count() + 1, m_frameInputNs);
+        m_frameInputNs = 0;
+        m_frameInputCount = 0;
+        // A frame that never reached the compositor gets no callback or feedback: don't wait for either
+        if (!m_renderer.draw_frame()) m_window.cancel_frame();
 		m_fps.end();
+		ZETA_PROFILER_FLUSH();
 		static int counter = 0;
 		if (counter++ > 200) {
 			counter = 0;
-			std::println("fps1: {}", m_fps.getFps());
+			std::println("fps1: {} (work {:.3f} ms, frame {:.3f} ms)", m_fps.getFps(), m_fps.getWorkMs(), m_fps.getFrameMs());
+			const auto& gpu = m_renderer.gpu_profiler();
+			if (gpu.enabled()) {
+				std::println("gpu: {:.3f} ms (main_pass {:.3f} ms)", gpu.latest().totalMs, gpu.pass_ms("main_pass"));
+				if (m_renderer.dynamic_resolution()) {
+					auto area = m_renderer.render_extent();
+					std::println("drs: scale {:.3f} ({}x{}, upscale {:.3f} ms)", m_renderer.render_scale(), area.width, area.height, gpu.pass_ms("upscale"));
+				}
+			}
+			auto workers = Zeta::Jobs::get().stats();
+			double busy = 0.0;
+			for (const auto& worker : workers) busy += worker.utilization;
+			std::println("jobs: {} threads, {:.1f}% average utilization", workers.size(), workers.empty() ? 0.0 : busy / workers.size() * 100.0);
+			auto heaps = m_renderer.residency().heaps();
+			for (size_t i = 0; i < heaps.size(); ++i) {
+				if (!heaps[i].deviceLocal) continue;
+				std::println("memory: heap {} {:.0f} / {:.0f} MiB", i, heaps[i].usage / 1048576.0, heaps[i].budget / 1048576.0);
+			}
+			if (m_window.has_presentation_feedback()) {
+				const auto& latency = Zeta::Metrics::get().histogram("input_to_present_us");
+				if (latency.count() > 0) {
+					std::println("input->present: p50 {:.2f} ms, p99 {:.2f} ms ({} frames)",
+						latency.quantile(0.5) / 1000.0, latency.quantile(0.99) / 1000.0, latency.count());
+				}
+			}
+			auto events = m_eventBus.stats();
+			if (events.dropped > 0) {
+				std::println("events: {} dropped, high water {}/{}", events.dropped, events.highWater, m_eventBus.capacity());
+			}
+			if (events.coalesced + events.deduped > 0) {
+				std::println("events: {} coalesced, {} deduped of {}", events.coalesced, events.deduped, events.pushed);
+			}
 			#ifndef NDEBUG
 			std::println("DEBUG");
 			#endif
@@ -58,4 +169,20 @@ void App::run() {
 
 };
 void App::quit() {
+	// Nothing may push input into the event bus past this point
+	m_window.stop_input_thread();
+	Zeta::TaskScheduler::get().shutdown();
+	Zeta::Jobs::get().shutdown();
+	Zeta::Metrics::get().stop();
+	m_renderer.allocator().print_report();
+	// ZETA_GPU_TRACE=/path/trace.json dumps the recent GPU pass history for chrome://tracing
+	if (const char* path = std::getenv("ZETA_GPU_TRACE")) {
+		if (m_renderer.gpu_profiler().write_chrome_trace(path)) std::println("gpu trace written to {}", path);
+	}
+#ifdef ZETA_PROFILE_ENABLED
+	// ZETA_CPU_TRACE=/path/trace.json dumps every recorded ZETA_ZONE
+	if (const char* path = std::getenv("ZETA_CPU_TRACE")) {
+		if (Zeta::Profiler::get().write_chrome_trace(path)) std::println("cpu trace written to {}", path);
+	}
+#endif
 };
\ No newline at end of file
@@ -6,12 +6,25 @@
 #include <Zeta/window.hpp>
 #include <Zeta/render.hpp>
 #include <Zeta/events.hpp>
+#include <Zeta/profiler.hpp>
+#include <Zeta/metrics.hpp>
+#include <Zeta/jobs.hpp>
+#include <Zeta/scheduler.hpp>
 
 class App {
     private:
     bool m_running = true;
     Fps m_fps;
 
+    // Frame-callback pacing (ZETA_FRAME_THROTTLE=0 disables): render only when the compositor
+    // asks for a frame, otherwise wait on the Wayland socket for at most IDLE_POLL_MS
+    static constexpr int IDLE_POLL_MS = 100;
+    bool m_throttleFrames = true;
+
+    // Input consumed since the last drawn frame: the earliest timestamp and how many events
+    uint64_t m_frameInputNs = 0;
+    uint32_t m_frameInputCount = 0;
+
     struct SpawnEnemyEvent { float x, y; };
     struct ToggleMenuEvent {};
 
@@ -20,13 +33,24 @@ class App {
         Zeta::QuitEvent, 
         Zeta::ResizeEvent, 
         Zeta::KeyEvent, 
+        Zeta::PointerMotionEvent,
+        Zeta::PointerPositionEvent,
+        Zeta::PointerButtonEvent,
         SpawnEnemyEvent, 
         ToggleMenuEvent
     >;
 
+    // Declared before the window: the input thread and Wayland callbacks push into it until the
+    // window is gone, and members are destroyed in reverse order
+    Zeta::EventBus<AppEvent> m_eventBus;
     Zeta::Window m_window;           // 3. Window (contains the Surface)
     Zeta::Renderer m_renderer;  
-    Zeta::EventBus<AppEvent> m_eventBus;
+    Zeta::Gauge& m_eventQueueDepth = Zeta::Metrics::get().gauge("event_queue_depth");
+    Zeta::Gauge& m_frameInputs = Zeta::Metrics::get().gauge("frame_input_events");
+    Zeta::Counter& m_throttledWaits = Zeta::Metrics::get().counter("frame_throttled_waits");
+
+    void poll_window(int timeoutMs);
+    void dispatch_events();
     
     public:
     App();
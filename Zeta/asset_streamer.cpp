@@ -0,0 +1,426 @@
+#include "Zeta/asset_streamer.hpp"
+#include "Zeta/profiler.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <print>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ZETA_HAVE_IO_URING
+#include <liburing.h>
+#endif
+
+namespace Zeta {
+
+namespace {
+
+constexpr uint64_t MAX_READ = 1ull << 30; // Per read call; longer ranges continue where they stopped
+constexpr uint32_t RING_DEPTH = 64;
+
+}
+
+AssetStreamer::~AssetStreamer() {
+    shutdown();
+}
+
+void AssetStreamer::init(TransferQueue& transfer, const Settings& settings) {
+    m_transfer = &transfer;
+    m_settings = settings;
+    m_lastRefill = Clock::now();
+    m_tokens = static_cast<double>(settings.bytesPerSecond) / 10.0;
+
+#ifdef ZETA_HAVE_IO_URING
+    // Containers and hardened kernels may refuse rings; the reader threads cover that
+    if (settings.useIoUring) {
+        auto* ring = new io_uring{};
+        if (int result = io_uring_queue_init(RING_DEPTH, ring, 0); result == 0) {
+            m_ring = ring;
+        } else {
+            delete ring;
+            std::println("asset streamer: io_uring unavailable ({}), using reader threads", std::strerror(-result));
+        }
+    }
+#endif
+
+    if (m_ring) {
+        m_threads.emplace_back([this](std::stop_token stop) { ring_loop(stop); });
+    } else {
+        for (uint32_t i = 0; i < std::max(1u, settings.fallbackThreads); ++i) {
+            m_threads.emplace_back([this](std::stop_token stop) { reader_loop(stop); });
+        }
+    }
+    std::println("asset streamer: {}", m_ring ? std::string("io_uring") : std::format("{} reader thread(s)", m_threads.size()));
+}
+
+void AssetStreamer::shutdown() {
+    // 1. Threads finish the reads they started (the kernel must be done with staging memory)
+    for (auto& thread : m_threads) thread.request_stop();
+    m_cv.notify_all();
+    m_threads.clear();
+
+#ifdef ZETA_HAVE_IO_URING
+    if (m_ring) {
+        io_uring_queue_exit(static_cast<io_uring*>(m_ring));
+        delete static_cast<io_uring*>(m_ring);
+        m_ring = nullptr;
+    }
+#endif
+
+    // 2. Drop what never ran, without callbacks
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_requests.empty() || !m_finished.empty()) {
+        std::println("asset streamer: shutting down with {} request(s) unfinished, {} undelivered", m_requests.size(), m_finished.size());
+    }
+    for (auto& [id, pending] : m_requests) {
+        if (pending->fd >= 0) ::close(pending->fd);
+        if (pending->staging) m_transfer->release(pending->staging);
+    }
+    for (auto& finished : m_finished) {
+        if (finished.completion.staging) m_transfer->release(finished.completion.staging);
+    }
+    m_requests.clear();
+    m_finished.clear();
+    m_queue = {};
+}
+
+AssetStreamer::RequestId AssetStreamer::request(Request request) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto pending = std::make_unique<Pending>();
+    pending->id = m_nextId++;
+    pending->seq = m_nextSeq++;
+    pending->request = std::move(request);
+    pending->submitted = Clock::now();
+
+    RequestId id = pending->id;
+    m_queue.push({ pending->request.priority, pending->seq, id });
+    m_requests.emplace(id, std::move(pending));
+    m_requestCount.add();
+    m_queueDepth.set(static_cast<double>(m_queue.size()));
+    m_cv.notify_one();
+    return id;
+}
+
+bool AssetStreamer::cancel(RequestId id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto it = m_requests.find(id); it != m_requests.end()) {
+        Pending& pending = *it->second;
+        // Queued: done now. In flight: its I/O thread finishes it as cancelled.
+        if (!pending.dispatched) finish(pending, Status::Cancelled);
+        else pending.cancelled.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    // Finished but not delivered yet: the callback still sees the cancellation
+    for (auto& finished : m_finished) {
+        if (finished.completion.id == id && finished.completion.status != Status::Cancelled) {
+            finished.completion.status = Status::Cancelled;
+            m_cancelled.add();
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t AssetStreamer::update() {
+    std::vector<Finished> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_finished);
+    }
+    if (finished.empty()) return 0;
+
+    ZETA_ZONE("AssetStreamer::update");
+    for (auto& entry : finished) {
+        m_latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry.submitted).count()));
+        if (entry.callback) entry.callback(entry.completion);
+        // No effect when the callback copied from it: the copy's ticket frees it instead
+        if (entry.completion.staging) m_transfer->release(entry.completion.staging);
+    }
+    return finished.size();
+}
+
+AssetStreamer::Stats AssetStreamer::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Stats{
+        .queued = static_cast<uint32_t>(m_requests.size()) - m_inFlight,
+        .inFlight = m_inFlight,
+        .bytesInFlight = m_bytesInFlight
+    };
+}
+
+// --- Dispatch (m_mutex held unless noted) ---
+
+AssetStreamer::Pending* AssetStreamer::next_request(std::unique_lock<std::mutex>&) {
+    // 1. Budgets: request count, bytes in flight (one oversized request may run alone), bandwidth
+    if (m_inFlight >= m_settings.maxRequestsInFlight) return nullptr;
+    if (m_inFlight > 0 && m_bytesInFlight >= m_settings.maxBytesInFlight) return nullptr;
+    if (m_settings.bytesPerSecond > 0) {
+        auto now = Clock::now();
+        double rate = static_cast<double>(m_settings.bytesPerSecond);
+        m_tokens = std::min(m_tokens + std::chrono::duration<double>(now - m_lastRefill).count() * rate, rate / 10.0);
+        m_lastRefill = now;
+        if (m_tokens <= 0.0) return nullptr;
+    }
+
+    // 2. Highest priority first; cancelled and requeued entries leave stale queue entries behind
+    while (!m_queue.empty()) {
+        QueueEntry top = m_queue.top();
+        m_queue.pop();
+        auto it = m_requests.find(top.id);
+        if (it == m_requests.end() || it->second->dispatched) continue;
+
+        it->second->dispatched = true;
+        ++m_inFlight;
+        m_queueDepth.set(static_cast<double>(m_queue.size()));
+        return it->second.get();
+    }
+    return nullptr;
+}
+
+AssetStreamer::Prepare AssetStreamer::prepare(Pending& pending, std::string& error) {
+    // Called without the lock: only the I/O thread that dispatched it touches these fields
+    if (pending.fd < 0) {
+        pending.fd = ::open(pending.request.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (pending.fd < 0) {
+            error = std::strerror(errno);
+            return Prepare::Failed;
+        }
+        struct stat info{};
+        if (::fstat(pending.fd, &info) != 0) {
+            error = std::strerror(errno);
+            return Prepare::Failed;
+        }
+        uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+        if (pending.request.offset >= fileSize) {
+            error = "empty range";
+            return Prepare::Failed;
+        }
+        pending.size = pending.request.size > 0 ? std::min(pending.request.size, fileSize - pending.request.offset)
+                                                : fileSize - pending.request.offset;
+        if (pending.size > m_transfer->staging_capacity()) {
+            error = std::format("{} bytes do not fit the {} byte staging ring", pending.size, m_transfer->staging_capacity());
+            return Prepare::Failed;
+        }
+    }
+
+    // Staging frees up as the transfer queue retires uploads; until then the request waits its turn
+    pending.staging = m_transfer->stage(pending.size);
+    return pending.staging ? Prepare::Ready : Prepare::Retry;
+}
+
+void AssetStreamer::requeue(Pending& pending) {
+    // Cancelled while its I/O thread held it: done now rather than read in full later
+    if (pending.cancelled.load(std::memory_order_relaxed)) {
+        finish(pending, Status::Cancelled);
+        return;
+    }
+    // No descriptor held while waiting: a deep queue behind a full ring would otherwise run out
+    if (pending.fd >= 0) {
+        ::close(pending.fd);
+        pending.fd = -1;
+    }
+    pending.dispatched = false;
+    --m_inFlight;
+    m_queue.push({ pending.request.priority, pending.seq, pending.id });
+    m_queueDepth.set(static_cast<double>(m_queue.size()));
+}
+
+void AssetStreamer::finish(Pending& pending, Status status, std::string error) {
+    if (pending.fd >= 0) ::close(pending.fd);
+    if (pending.dispatched) --m_inFlight;
+    if (pending.staging) m_bytesInFlight -= pending.size;
+
+    switch (status) {
+        case Status::Done: m_completed.add(); break;
+        case Status::Failed: m_failed.add(); break;
+        case Status::Cancelled: m_cancelled.add(); break;
+    }
+    m_finished.push_back({
+        .completion = {
+            .id = pending.id,
+            .status = status,
+            .path = std::move(pending.request.path),
+            .staging = pending.staging,
+            .error = std::move(error)
+        },
+        .callback = std::move(pending.request.onComplete),
+        .submitted = pending.submitted
+    });
+    m_bytesInFlightGauge.set(static_cast<double>(m_bytesInFlight));
+    m_requests.erase(pending.id); // Destroys pending
+    m_cv.notify_all();            // Budget freed
+}
+
+std::chrono::microseconds AssetStreamer::backoff() const {
+    // Out of bandwidth: sleep until the bucket refills; otherwise retry staging soon
+    if (m_settings.bytesPerSecond > 0 && m_tokens <= 0.0) {
+        double seconds = -m_tokens / static_cast<double>(m_settings.bytesPerSecond);
+        return std::clamp(std::chrono::microseconds(static_cast<int64_t>(seconds * 1e6)),
+                          std::chrono::microseconds(500), std::chrono::microseconds(10000));
+    }
+    return std::chrono::microseconds(1000);
+}
+
+// --- Reader threads (fallback) ---
+
+void AssetStreamer::reader_loop(std::stop_token stop) {
+    ZETA_THREAD_NAME("stream_reader");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!stop.stop_requested()) {
+        Pending* pending = next_request(lock);
+        if (!pending) {
+            if (m_queue.empty()) m_cv.wait(lock, stop, [&] { return !m_queue.empty(); });
+            else m_cv.wait_for(lock, backoff());
+            continue;
+        }
+
+        // 1. Open and stage outside the lock
+        lock.unlock();
+        std::string error;
+        Prepare prepared = prepare(*pending, error);
+        lock.lock();
+        if (prepared == Prepare::Retry) {
+            requeue(*pending);
+            m_cv.wait_for(lock, backoff());
+            continue;
+        }
+        if (prepared == Prepare::Failed) {
+            finish(*pending, Status::Failed, std::move(error));
+            continue;
+        }
+        m_bytesInFlight += pending->size;
+        m_tokens -= static_cast<double>(pending->size);
+        m_bytesInFlightGauge.set(static_cast<double>(m_bytesInFlight));
+        lock.unlock();
+
+        // 2. Blocking reads straight into the mapped staging slice
+        while (pending->done < pending->size && !pending->cancelled.load(std::memory_order_relaxed)) {
+            uint64_t chunk = std::min(pending->size - pending->done, MAX_READ);
+            ssize_t n = ::pread(pending->fd, pending->staging.data + pending->done, chunk,
+                                static_cast<off_t>(pending->request.offset + pending->done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                error = n < 0 ? std::strerror(errno) : "unexpected end of file";
+                break;
+            }
+            pending->done += static_cast<uint64_t>(n);
+            m_bytesRead.add(static_cast<uint64_t>(n));
+        }
+
+        lock.lock();
+        Status status = pending->cancelled.load(std::memory_order_relaxed) ? Status::Cancelled
+                      : error.empty() ? Status::Done : Status::Failed;
+        finish(*pending, status, std::move(error));
+    }
+}
+
+// --- io_uring ---
+
+#ifdef ZETA_HAVE_IO_URING
+
+bool AssetStreamer::submit_read(Pending& pending) {
+    auto* ring = static_cast<io_uring*>(m_ring);
+    io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    if (!sqe) {
+        io_uring_submit(ring);
+        sqe = io_uring_get_sqe(ring);
+        if (!sqe) return false;
+    }
+    uint64_t chunk = std::min(pending.size - pending.done, MAX_READ);
+    io_uring_prep_read(sqe, pending.fd, pending.staging.data + pending.done, static_cast<unsigned>(chunk),
+                       pending.request.offset + pending.done);
+    io_uring_sqe_set_data(sqe, &pending);
+    ++m_ringReads;
+    return true;
+}
+
+void AssetStreamer::ring_loop(std::stop_token stop) {
+    ZETA_THREAD_NAME("stream_uring");
+    auto* ring = static_cast<io_uring*>(m_ring);
+
+    while (true) {
+        // On stop nothing new is dispatched, but reads already in the kernel are waited for
+        bool stopping = stop.stop_requested();
+        if (stopping && m_ringReads == 0) break;
+
+        // 1. Dispatch into free ring slots
+        if (!stopping) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            bool backOff = false;
+            while (m_ringReads < RING_DEPTH) {
+                Pending* pending = next_request(lock);
+                if (!pending) break;
+
+                lock.unlock();
+                std::string error;
+                Prepare prepared = prepare(*pending, error);
+                lock.lock();
+                if (prepared == Prepare::Retry) {
+                    requeue(*pending);
+                    backOff = true;
+                    break;
+                }
+                if (prepared == Prepare::Failed) {
+                    finish(*pending, Status::Failed, std::move(error));
+                    continue;
+                }
+                m_bytesInFlight += pending->size;
+                m_tokens -= static_cast<double>(pending->size);
+                m_bytesInFlightGauge.set(static_cast<double>(m_bytesInFlight));
+                if (!submit_read(*pending)) finish(*pending, Status::Failed, "io_uring submission queue full");
+            }
+
+            // Idle: sleep until a request arrives or a budget frees up
+            if (m_ringReads == 0) {
+                if (m_queue.empty() && !backOff) m_cv.wait(lock, stop, [&] { return !m_queue.empty(); });
+                else m_cv.wait_for(lock, backoff());
+                continue;
+            }
+        }
+
+        // 2. Reap with a short timeout so new requests are picked up while reads are in flight
+        io_uring_submit(ring);
+        __kernel_timespec timeout{ .tv_sec = 0, .tv_nsec = 1'000'000 };
+        io_uring_cqe* cqe = nullptr;
+        if (io_uring_wait_cqe_timeout(ring, &cqe, &timeout) != 0) continue;
+
+        unsigned head;
+        unsigned seen = 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        io_uring_for_each_cqe(ring, head, cqe) {
+            ++seen;
+            --m_ringReads;
+            auto* pending = static_cast<Pending*>(io_uring_cqe_get_data(cqe));
+            int result = cqe->res;
+
+            if (result == -EINTR || result == -EAGAIN) {
+                if (!submit_read(*pending)) finish(*pending, Status::Failed, "io_uring submission queue full");
+                continue;
+            }
+            if (result <= 0) {
+                finish(*pending, Status::Failed, result < 0 ? std::strerror(-result) : "unexpected end of file");
+                continue;
+            }
+            pending->done += static_cast<uint64_t>(result);
+            m_bytesRead.add(static_cast<uint64_t>(result));
+
+            // Short reads continue; cancellation only lands between reads
+            if (pending->cancelled.load(std::memory_order_relaxed)) finish(*pending, Status::Cancelled);
+            else if (pending->done < pending->size && !submit_read(*pending)) finish(*pending, Status::Failed, "io_uring submission queue full");
+            else if (pending->done == pending->size) finish(*pending, Status::Done);
+        }
+        io_uring_cq_advance(ring, seen);
+    }
+}
+
+#else
+
+bool AssetStreamer::submit_read(Pending&) { return false; }
+void AssetStreamer::ring_loop(std::stop_token) {}
+
+#endif
+
+} // namespace Zeta
@@ -0,0 +1,515 @@
+// zeta_bench: micro and macro benchmarks for the Zeta library, results as JSON.
+//
+//   zeta_bench [--out zeta_bench.json] [--frames N] [--fif 1,2,3] [--producers N] [--draws N]
+//              [--width W] [--height H] [--assets DIR] [--spirv FILE] [--no-gpu]
+//
+// --assets is the directory holding shaders/ (the headless renderer loads
+// shaders/triangle.*.spv relative to it), e.g. the Iota project directory.
+// Results always go to the --out file: the engine logs to stdout, which would corrupt the JSON.
+
+#include <Zeta/events.hpp>
+#include <Zeta/jobs.hpp>
+#include <Zeta/render.hpp>
+#include <Zeta/time.hpp>
+#include <Zeta/tlsf.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <print>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string out = "zeta_bench.json";
+    std::string assets;
+    std::string spirv = "shaders/triangle.vert.spv";
+    uint32_t frames = 500;
+    uint32_t draws = 20000;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    uint32_t maxProducers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    std::vector<uint32_t> framesInFlight = { 1, 2, 3 };
+    bool gpu = true;
+};
+
+struct Result {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    std::vector<std::pair<std::string, double>> metrics;
+    std::string error;
+};
+
+double elapsed_ns(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+double thread_cpu_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e9 + static_cast<double>(ts.tv_nsec);
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (c == '\n') { out += "\\n"; continue; }
+        out += c;
+    }
+    return out;
+}
+
+// --- EventBus: P producers push, one consumer drains ---
+
+Result bench_event_bus(uint32_t producers) {
+    constexpr uint32_t EventsPerProducer = 200000;
+    using Bus = Zeta::EventBus<Zeta::CoreEvent, 4096, Zeta::OverflowPolicy::Block>;
+    auto bus = std::make_unique<Bus>();
+
+    std::atomic<bool> go{false};
+    std::vector<std::jthread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) {}
+            for (uint32_t i = 0; i < EventsPerProducer; ++i) {
+                bus->push(Zeta::KeyEvent{ p, (i & 1) != 0 });
+            }
+        });
+    }
+
+    uint64_t total = static_cast<uint64_t>(producers) * EventsPerProducer;
+    uint64_t received = 0;
+    uint64_t drains = 0;
+
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    while (received < total) {
+        received += bus->drain([](const Zeta::CoreEvent&) {});
+        ++drains;
+    }
+    double ns = elapsed_ns(start);
+    threads.clear();
+
+    auto stats = bus->stats();
+    return {
+        .name = "event_bus_push_drain",
+        .params = { { "producers", std::to_string(producers) }, { "capacity", "4096" } },
+        .metrics = {
+            { "events", static_cast<double>(total) },
+            { "ns_per_event", ns / static_cast<double>(total) },
+            { "mevents_per_sec", static_cast<double>(total) / ns * 1e3 },
+            { "events_per_drain", static_cast<double>(total) / static_cast<double>(drains) },
+            { "producer_blocked", static_cast<double>(stats.blocked) },
+            { "high_water", static_cast<double>(stats.highWater) }
+        }
+    };
+}
+
+Result bench_event_bus_poll() {
+    // Single-threaded push then poll() one by one, the pre-drain consumption pattern
+    constexpr uint32_t Events = 1000000;
+    auto bus = std::make_unique<Zeta::EventBus<Zeta::CoreEvent, 1024>>();
+
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < Events; i += 512) {
+        for (uint32_t j = 0; j < 512; ++j) bus->push(Zeta::ResizeEvent{ i, j });
+        while (bus->poll()) {}
+    }
+    double ns = elapsed_ns(start);
+
+    return {
+        .name = "event_bus_push_poll",
+        .params = { { "producers", "0" } },
+        .metrics = { { "ns_per_event", ns / Events } }
+    };
+}
+
+// --- TLSF sub-allocator (the GpuAllocator's per-block bookkeeping) ---
+
+Result bench_tlsf() {
+    // Steady-state churn: a fixed working set of mixed sizes, one random free + allocate per step
+    constexpr uint32_t Live = 4096;
+    constexpr uint32_t Steps = 1000000;
+    Zeta::Tlsf tlsf(uint64_t{1} << 30);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint64_t> sizeDist(256, 256 * 1024);
+
+    std::vector<uint32_t> nodes;
+    nodes.reserve(Live);
+    for (uint32_t i = 0; i < Live; ++i) nodes.push_back(tlsf.allocate(sizeDist(rng), 256)->node);
+
+    uint32_t failed = 0;
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < Steps; ++i) {
+        uint32_t slot = static_cast<uint32_t>(rng() % Live);
+        tlsf.free(nodes[slot]);
+        auto range = tlsf.allocate(sizeDist(rng), 256);
+        if (!range) {
+            ++failed;
+            range = tlsf.allocate(256, 256);
+        }
+        nodes[slot] = range->node;
+    }
+    double ns = elapsed_ns(start);
+
+    uint64_t freeBytes = tlsf.capacity() - tlsf.used();
+    return {
+        .name = "tlsf_churn",
+        .params = { { "live", std::to_string(Live) } },
+        .metrics = {
+            { "ns_per_free_alloc", ns / Steps },
+            { "failed", static_cast<double>(failed) },
+            { "fragmentation", freeBytes > 0 ? 1.0 - static_cast<double>(tlsf.largest_free()) / static_cast<double>(freeBytes) : 0.0 }
+        }
+    };
+}
+
+// --- Job system ---
+
+Result bench_jobs() {
+    // Spawn/wait overhead with empty jobs, then parallel_for speedup on a memory-light reduction
+    constexpr uint32_t EmptyJobs = 100000;
+    constexpr uint32_t Elements = 1u << 24;
+    auto& jobs = Zeta::Jobs::get();
+
+    Zeta::JobCounter counter;
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < EmptyJobs; ++i) jobs.run([] {}, &counter);
+    jobs.wait(counter);
+    double spawnNs = elapsed_ns(start) / EmptyJobs;
+
+    auto work = [](uint32_t i) {
+        uint64_t x = i * 0x9e3779b97f4a7c15ull;
+        for (int k = 0; k < 16; ++k) x ^= x >> 13, x *= 0xff51afd7ed558ccdull;
+        return x;
+    };
+
+    std::vector<uint64_t> out(Elements / 1024);
+    start = Clock::now();
+    for (uint32_t c = 0; c < out.size(); ++c) {
+        uint64_t acc = 0;
+        for (uint32_t i = c * 1024; i < (c + 1) * 1024; ++i) acc += work(i);
+        out[c] = acc;
+    }
+    double serialNs = elapsed_ns(start);
+
+    start = Clock::now();
+    jobs.parallel_for(0, static_cast<uint32_t>(out.size()), [&](uint32_t c) {
+        uint64_t acc = 0;
+        for (uint32_t i = c * 1024; i < (c + 1) * 1024; ++i) acc += work(i);
+        out[c] = acc;
+    });
+    double parallelNs = elapsed_ns(start);
+
+    auto workers = jobs.stats();
+    double busy = 0.0;
+    for (const auto& worker : workers) busy += worker.utilization;
+
+    return {
+        .name = "jobs",
+        .params = { { "threads", std::to_string(jobs.thread_count()) } },
+        .metrics = {
+            { "spawn_wait_ns_per_job", spawnNs },
+            { "parallel_for_serial_ms", serialNs / 1e6 },
+            { "parallel_for_ms", parallelNs / 1e6 },
+            { "parallel_for_speedup", serialNs / parallelNs },
+            { "mean_utilization", workers.empty() ? 0.0 : busy / static_cast<double>(workers.size()) }
+        }
+    };
+}
+
+// --- Timing primitives ---
+
+Result bench_fps_overhead() {
+    constexpr uint32_t Iterations = 200000;
+    Fps fps;
+    fps.m_limit = 0; // Pacing disabled, measure bookkeeping only
+
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < Iterations; ++i) {
+        fps.begin();
+        fps.end();
+    }
+    double fpsNs = elapsed_ns(start) / Iterations;
+
+    Timer timer;
+    start = Clock::now();
+    for (uint32_t i = 0; i < Iterations; ++i) {
+        timer.begin();
+        timer.end();
+    }
+    double timerNs = elapsed_ns(start) / Iterations;
+
+    return {
+        .name = "timing_overhead",
+        .metrics = { { "fps_begin_end_ns", fpsNs }, { "timer_begin_end_ns", timerNs } }
+    };
+}
+
+Result bench_fps_pacing(uint32_t frames) {
+    // How closely the pacer hits a 250 Hz schedule with a trivial workload
+    Fps fps;
+    fps.m_limit = 250;
+    double sumError = 0.0;
+    double maxError = 0.0;
+
+    fps.begin();
+    fps.end();
+    for (uint32_t i = 0; i < frames; ++i) {
+        fps.begin();
+        fps.end();
+        if (i == 0) continue;
+        double error = std::abs(fps.getFrameMs() - 4.0);
+        sumError += error;
+        maxError = std::max(maxError, error);
+    }
+
+    return {
+        .name = "fps_pacing",
+        .params = { { "limit", "250" } },
+        .metrics = {
+            { "mean_abs_error_us", sumError / std::max(1u, frames - 1) * 1000.0 },
+            { "max_abs_error_us", maxError * 1000.0 },
+            { "spin_margin_us", fps.pacer().getSpinMarginUs() }
+        }
+    };
+}
+
+// --- SPIR-V loading ---
+
+Result bench_spirv(const std::string& path) {
+    Result result{ .name = "load_spirv", .params = { { "file", path } } };
+    constexpr uint32_t Iterations = 2000;
+
+    try {
+        size_t bytes = 0;
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < Iterations; ++i) {
+            bytes += Zeta::load_spirv(path).size() * sizeof(uint32_t);
+        }
+        double ns = elapsed_ns(start);
+        result.metrics = {
+            { "us_per_load", ns / Iterations / 1000.0 },
+            { "mb_per_sec", static_cast<double>(bytes) / ns * 1e3 },
+            { "bytes", static_cast<double>(bytes / Iterations) }
+        };
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+// --- Headless frame throughput ---
+
+Result bench_headless(const Options& options, uint32_t framesInFlight) {
+    Result result{
+        .name = "headless_frames",
+        .params = {
+            { "frames_in_flight", std::to_string(framesInFlight) },
+            { "width", std::to_string(options.width) },
+            { "height", std::to_string(options.height) },
+            { "frames", std::to_string(options.frames) }
+        }
+    };
+
+    try {
+        Zeta::Renderer renderer;
+        renderer.set_frames_in_flight(framesInFlight);
+        renderer.init_headless(options.width, options.height);
+
+        // Warm up pipelines, caches and the profiler ring
+        for (uint32_t i = 0; i < 20; ++i) renderer.draw_frame();
+
+        double cpuStart = thread_cpu_ns();
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < options.frames; ++i) renderer.draw_frame();
+        // Include the tail of in-flight work so runs with more frames in flight compare fairly
+        renderer.request_readback();
+        renderer.draw_frame();
+        (void)renderer.take_readback();
+        double wallNs = elapsed_ns(start);
+        double cpuNs = thread_cpu_ns() - cpuStart;
+
+        uint32_t frames = options.frames + 1;
+        result.metrics = {
+            { "fps", frames / (wallNs / 1e9) },
+            { "wall_ms_per_frame", wallNs / frames / 1e6 },
+            { "cpu_ms_per_frame", cpuNs / frames / 1e6 },
+            { "gpu_ms_last_frame", renderer.gpu_profiler().latest().totalMs }
+        };
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+// --- Command recording scaling ---
+
+Result bench_recording(const Options& options, uint32_t threads) {
+    Result result{
+        .name = "parallel_recording",
+        .params = {
+            { "threads", std::to_string(threads) },
+            { "draws", std::to_string(options.draws) },
+            { "frames", std::to_string(options.frames) }
+        }
+    };
+
+    try {
+        Zeta::Renderer renderer;
+        renderer.set_recording_threads(threads); // 0: everything on the primary, single-threaded
+        renderer.init_headless(options.width, options.height);
+        renderer.set_draw_count(options.draws);
+
+        for (uint32_t i = 0; i < 20; ++i) renderer.draw_frame();
+
+        double sum = 0.0;
+        double best = 1e30;
+        for (uint32_t i = 0; i < options.frames; ++i) {
+            renderer.draw_frame();
+            sum += renderer.last_record_ms();
+            best = std::min(best, static_cast<double>(renderer.last_record_ms()));
+        }
+        result.metrics = {
+            { "record_ms_mean", sum / std::max(1u, options.frames) },
+            { "record_ms_min", best },
+            { "ns_per_draw", sum / std::max(1u, options.frames) * 1e6 / std::max(1u, options.draws) }
+        };
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+std::vector<uint32_t> parse_list(const std::string& text) {
+    std::vector<uint32_t> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) values.push_back(static_cast<uint32_t>(std::stoul(item)));
+    return values;
+}
+
+Options parse_options(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--out") options.out = next();
+        else if (arg == "--assets") options.assets = next();
+        else if (arg == "--spirv") options.spirv = next();
+        else if (arg == "--frames") options.frames = static_cast<uint32_t>(std::stoul(next()));
+        else if (arg == "--width") options.width = static_cast<uint32_t>(std::stoul(next()));
+        else if (arg == "--height") options.height = static_cast<uint32_t>(std::stoul(next()));
+        else if (arg == "--draws") options.draws = static_cast<uint32_t>(std::stoul(next()));
+        else if (arg == "--producers") options.maxProducers = static_cast<uint32_t>(std::stoul(next()));
+        else if (arg == "--fif") {
+            options.framesInFlight = parse_list(next());
+            for (uint32_t fif : options.framesInFlight) {
+                if (fif < 1 || fif > Zeta::Renderer::max_frames_in_flight()) {
+                    throw std::runtime_error(std::format("--fif values must be in [1, {}]", Zeta::Renderer::max_frames_in_flight()));
+                }
+            }
+        }
+        else if (arg == "--no-gpu") options.gpu = false;
+        else throw std::runtime_error("unknown option " + arg);
+    }
+    return options;
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results) {
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    out << "{\n  \"benchmark\": \"zeta_bench\",\n  \"version\": 1,\n  \"timestamp\": " << now
+        << ",\n  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [\n";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const auto& result = results[r];
+        out << "    { \"name\": \"" << result.name << "\", \"params\": {";
+        for (size_t i = 0; i < result.params.size(); ++i) {
+            out << (i ? ", " : "") << "\"" << result.params[i].first << "\": \"" << json_escape(result.params[i].second) << "\"";
+        }
+        out << "}, \"metrics\": {";
+        for (size_t i = 0; i < result.metrics.size(); ++i) {
+            // A run without samples can produce nan/inf, which JSON has no literal for
+            out << (i ? ", " : "") << "\"" << result.metrics[i].first << "\": ";
+            if (std::isfinite(result.metrics[i].second)) out << result.metrics[i].second;
+            else out << "null";
+        }
+        out << "}";
+        if (!result.error.empty()) out << ", \"error\": \"" << json_escape(result.error) << "\"";
+        out << " }" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::println(stderr, "zeta_bench: {}", e.what());
+        return 2;
+    }
+
+    // --out is relative to where we were started, not to --assets
+    options.out = std::filesystem::absolute(options.out).string();
+    if (!options.assets.empty()) std::filesystem::current_path(options.assets);
+
+    std::vector<Result> results;
+    for (uint32_t producers = 1; producers <= options.maxProducers; ++producers) {
+        results.push_back(bench_event_bus(producers));
+    }
+    results.push_back(bench_event_bus_poll());
+    results.push_back(bench_tlsf());
+
+    Zeta::Jobs::get().init();
+    results.push_back(bench_jobs());
+    Zeta::Jobs::get().shutdown();
+
+    results.push_back(bench_fps_overhead());
+    results.push_back(bench_fps_pacing(std::min(options.frames, 500u)));
+    results.push_back(bench_spirv(options.spirv));
+
+    if (options.gpu) {
+        for (uint32_t fif : options.framesInFlight) {
+            results.push_back(bench_headless(options, fif));
+        }
+        // Recording time vs. thread count, 0 being the single-threaded primary path
+        results.push_back(bench_recording(options, 0));
+        for (uint32_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+            results.push_back(bench_recording(options, threads));
+        }
+    }
+
+    std::ofstream file(options.out);
+    if (file) write_json(file, results);
+    file.close();
+    if (!file) {
+        std::println(stderr, "zeta_bench: failed to write {}", options.out);
+        return 1;
+    }
+    std::println("zeta_bench: wrote {} results to {}", results.size(), options.out);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/command_recorder.hpp"
+#include "Zeta/profiler.hpp"
+#include <format>
+#include <print>
+
+namespace Zeta {
+
+ParallelRecorder::~ParallelRecorder() {
+    shutdown();
+}
+
+void ParallelRecorder::init(const vk::raii::Device& device, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t framesInFlight) {
+    shutdown();
+    m_device = &device;
+
+    // 1. One transient pool per thread per slot; buffers are allocated lazily as chunk counts grow
+    for (uint32_t i = 0; i < std::max(threadCount, 1u); ++i) {
+        auto state = std::make_unique<ThreadState>();
+        for (uint32_t slot = 0; slot < framesInFlight; ++slot) {
+            state->slots.push_back(SlotPool{
+                .pool = vk::raii::CommandPool(device, vk::CommandPoolCreateInfo{
+                    .flags = vk::CommandPoolCreateFlagBits::eTransient,
+                    .queueFamilyIndex = queueFamilyIndex
+                })
+            });
+        }
+        m_threads.push_back(std::move(state));
+    }
+
+    // 2. Helpers park on m_start; the caller is thread 0
+    for (uint32_t i = 1; i < m_threads.size(); ++i) {
+        m_threads[i]->thread = std::jthread([this, i](std::stop_token stop) { worker_loop(stop, i); });
+    }
+
+    std::println("parallel recorder: {} thread(s), {} slot(s)", m_threads.size(), framesInFlight);
+}
+
+void ParallelRecorder::shutdown() {
+    for (auto& state : m_threads) state->thread.request_stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_start.notify_all();
+    }
+    m_threads.clear(); // Joins helpers, then frees their pools
+}
+
+void ParallelRecorder::begin_frame(uint32_t slot) {
+    m_slot = slot;
+    for (auto& state : m_threads) {
+        SlotPool& pool = state->slots[slot];
+        if (pool.used == 0) continue;
+        pool.pool.reset();
+        pool.used = 0;
+    }
+}
+
+vk::raii::CommandBuffer& ParallelRecorder::next_buffer(ThreadState& state) {
+    SlotPool& pool = state.slots[m_slot];
+    if (pool.used == pool.buffers.size()) {
+        vk::raii::CommandBuffers more(*m_device, vk::CommandBufferAllocateInfo{
+            .commandPool = *pool.pool,
+            .level = vk::CommandBufferLevel::eSecondary,
+            .commandBufferCount = std::max<uint32_t>(4, static_cast<uint32_t>(pool.buffers.size()))
+        });
+        for (auto& buffer : more) pool.buffers.push_back(std::move(buffer));
+    }
+    return pool.buffers[pool.used++];
+}
+
+void ParallelRecorder::record_chunks(uint32_t index) {
+    ThreadState& state = *m_threads[index];
+    try {
+        // Chunks are claimed dynamically so a slow chunk does not stall a fixed partition
+        for (uint32_t chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < m_chunkCount;
+             chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+            auto& cmd = next_buffer(state);
+            cmd.begin({
+                .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+                .pInheritanceInfo = &m_inheritance
+            });
+            (*m_fn)(cmd, chunk);
+            cmd.end();
+            m_results[chunk] = *cmd;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) m_error = std::current_exception();
+        m_nextChunk.store(m_chunkCount, std::memory_order_relaxed); // Others stop claiming
+    }
+}
+
+void ParallelRecorder::worker_loop(std::stop_token stop, uint32_t index) {
+    ZETA_THREAD_NAME(std::format("record_{}", index).c_str());
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&] { return stop.stop_requested() || m_generation != seen; });
+            if (stop.stop_requested()) return;
+            seen = m_generation;
+        }
+
+        {
+            ZETA_ZONE("record_secondaries");
+            record_chunks(index);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_running == 0) m_done.notify_one();
+    }
+}
+
+std::span<const vk::CommandBuffer> ParallelRecorder::record(uint32_t chunkCount, const vk::CommandBufferInheritanceRenderingInfo& rendering, const RecordFn& fn) {
+    ZETA_ZONE("ParallelRecorder::record");
+    m_results.assign(chunkCount, vk::CommandBuffer{});
+    if (chunkCount == 0 || m_threads.empty()) return {};
+
+    // 1. Publish the job: helpers only read it after seeing the new generation under the lock
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rendering = rendering;
+        m_inheritance = vk::CommandBufferInheritanceInfo{ .pNext = &m_rendering };
+        m_fn = &fn;
+        m_chunkCount = chunkCount;
+        m_nextChunk.store(0, std::memory_order_relaxed);
+        m_error = nullptr;
+        m_running = static_cast<uint32_t>(m_threads.size()) - 1;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    // 2. Record alongside the helpers, then wait for the stragglers
+    record_chunks(0);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&] { return m_running == 0; });
+        m_fn = nullptr;
+    }
+
+    if (m_error) std::rethrow_exception(m_error);
+    return m_results;
+}
+
+} // namespace Zeta
@@ -0,0 +1,51 @@
+#include "Zeta/dynamic_resolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Zeta {
+
+void DynamicResolution::configure(const Settings& settings) {
+    m_settings = settings;
+    m_settings.minScale = std::clamp(settings.minScale, 0.1f, 1.0f);
+    m_settings.maxScale = std::clamp(settings.maxScale, m_settings.minScale, 1.0f);
+    m_scale = enabled() ? m_settings.maxScale : 1.0f;
+    m_filteredMs = 0.0;
+    m_lastChangeFrame = m_lastFrame;
+
+    m_scaleGauge.set(m_scale);
+    m_targetGauge.set(m_settings.targetMs);
+}
+
+float DynamicResolution::update(uint64_t frame, double gpuMs) {
+    if (!enabled() || frame <= m_lastFrame || gpuMs <= 0.0) return m_scale;
+    m_lastFrame = frame;
+
+    // 1. Frames resolved right after a change were recorded before it: they say nothing about
+    //    the new scale, so they don't even enter the filter
+    if (frame < m_lastChangeFrame + m_settings.cooldownFrames) return m_scale;
+
+    // 2. Smooth out single-frame spikes
+    m_filteredMs = m_filteredMs == 0.0 ? gpuMs : m_filteredMs + FILTER_ALPHA * (gpuMs - m_filteredMs);
+    m_gpuMsGauge.set(m_filteredMs);
+
+    // 3. Proportional step on the pixel count, asymmetric limits, quantized
+    double ratio = m_settings.targetMs / m_filteredMs;
+    float wanted = m_scale * static_cast<float>(std::sqrt(ratio));
+    float next = m_scale;
+    if (m_filteredMs > m_settings.targetMs) {
+        next = std::max(wanted, m_scale * (1.0f - MAX_DROP));
+    } else if (m_filteredMs < m_settings.targetMs * RAISE_BELOW) {
+        next = std::min(wanted, m_scale * (1.0f + MAX_RAISE));
+    }
+    next = std::clamp(std::round(next / QUANTUM) * QUANTUM, m_settings.minScale, m_settings.maxScale);
+    if (next == m_scale) return m_scale;
+
+    (next < m_scale ? m_drops : m_raises).add();
+    m_scale = next;
+    m_lastChangeFrame = frame;
+    m_filteredMs = 0.0;
+    m_scaleGauge.set(m_scale);
+    return m_scale;
+}
+
+} // namespace Zeta
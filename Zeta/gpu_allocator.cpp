@@ -0,0 +1,393 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/gpu_allocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <utility>
+
+namespace Zeta {
+
+namespace {
+
+constexpr double MIB = 1024.0 * 1024.0;
+
+vk::DeviceSize align_up(vk::DeviceSize value, vk::DeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+// --- GpuAllocation ---
+
+GpuAllocation& GpuAllocation::operator=(GpuAllocation&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_allocator = std::exchange(other.m_allocator, nullptr);
+        m_owner = other.m_owner;
+        m_node = other.m_node;
+        m_memory = other.m_memory;
+        m_offset = other.m_offset;
+        m_size = other.m_size;
+        m_mapped = other.m_mapped;
+        m_memoryType = other.m_memoryType;
+    }
+    return *this;
+}
+
+void GpuAllocation::reset() {
+    if (m_allocator) m_allocator->release(*this);
+    m_allocator = nullptr;
+    m_owner = nullptr;
+    m_node = Tlsf::INVALID;
+    m_memory = nullptr;
+    m_mapped = nullptr;
+}
+
+// --- GpuAllocator ---
+
+GpuAllocator::~GpuAllocator() {
+    if (m_device == nullptr) return;
+    uint32_t live = static_cast<uint32_t>(m_dedicated.size());
+    for (const Pool& pool : m_pools) {
+        for (const auto& block : pool.blocks) live += block->tlsf.allocation_count();
+    }
+    if (live > 0) {
+        std::println("gpu allocator: destroyed with {} live allocation(s), {:.1f} MiB", live, static_cast<double>(m_used) / MIB);
+    }
+}
+
+void GpuAllocator::init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice, const Settings& settings) {
+    m_device = &device;
+    m_memoryProperties = physicalDevice.getMemoryProperties();
+    auto properties = physicalDevice.getProperties();
+    m_granularity = std::max<vk::DeviceSize>(properties.limits.bufferImageGranularity, 1);
+    m_nonCoherentAtomSize = std::max<vk::DeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+    m_maxAllocations = properties.limits.maxMemoryAllocationCount;
+    m_heaps.assign(m_memoryProperties.memoryHeapCount, {});
+
+    m_settings = settings;
+    if (m_settings.dedicatedThreshold == 0) m_settings.dedicatedThreshold = m_settings.blockSize / 2;
+
+    // Fixed size: blocks point back at their pool by index
+    m_pools.resize(m_memoryProperties.memoryTypeCount * 2);
+    for (uint32_t i = 0; i < m_pools.size(); ++i) {
+        m_pools[i].memoryType = i / 2;
+        m_pools[i].optimal = (i % 2) == 1;
+    }
+    publish_metrics();
+}
+
+GpuAllocation GpuAllocator::bind(const vk::raii::Image& image, MemoryUsage usage) {
+    auto chain = m_device->getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(
+        vk::ImageMemoryRequirementsInfo2{ .image = *image });
+    const auto& requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+    const auto& dedicated = chain.get<vk::MemoryDedicatedRequirements>();
+
+    vk::MemoryDedicatedAllocateInfo dedicatedInfo{ .image = *image };
+    bool wantsDedicated = dedicated.prefersDedicatedAllocation || dedicated.requiresDedicatedAllocation;
+    GpuAllocation allocation = allocate_impl(requirements, usage, true, wantsDedicated, &dedicatedInfo);
+    image.bindMemory(allocation.memory(), allocation.offset());
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::bind(const vk::raii::Buffer& buffer, MemoryUsage usage) {
+    auto chain = m_device->getBufferMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(
+        vk::BufferMemoryRequirementsInfo2{ .buffer = *buffer });
+    const auto& requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+    const auto& dedicated = chain.get<vk::MemoryDedicatedRequirements>();
+
+    vk::MemoryDedicatedAllocateInfo dedicatedInfo{ .buffer = *buffer };
+    bool wantsDedicated = dedicated.prefersDedicatedAllocation || dedicated.requiresDedicatedAllocation;
+    GpuAllocation allocation = allocate_impl(requirements, usage, false, wantsDedicated, &dedicatedInfo);
+    buffer.bindMemory(allocation.memory(), allocation.offset());
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::allocate(const vk::MemoryRequirements& requirements, MemoryUsage usage, bool optimal, bool dedicated) {
+    return allocate_impl(requirements, usage, optimal, dedicated, nullptr);
+}
+
+std::vector<uint32_t> GpuAllocator::candidate_types(uint32_t typeBits, MemoryUsage usage) const {
+    using Flag = vk::MemoryPropertyFlagBits;
+    vk::MemoryPropertyFlags required, preferred, avoided;
+    switch (usage) {
+        case MemoryUsage::GpuOnly:
+            preferred = Flag::eDeviceLocal;
+            avoided = Flag::eHostVisible;
+            break;
+        case MemoryUsage::Upload:
+            // Write-combined system memory; the small device-local BAR heap is left to callers that ask for it
+            required = Flag::eHostVisible;
+            preferred = Flag::eHostCoherent;
+            avoided = Flag::eHostCached | Flag::eDeviceLocal;
+            break;
+        case MemoryUsage::Readback:
+            required = Flag::eHostVisible;
+            preferred = Flag::eHostCached | Flag::eHostCoherent;
+            break;
+    }
+    // Never handed out here: lazily allocated and protected memory need special resources
+    vk::MemoryPropertyFlags excluded = Flag::eProtected | Flag::eLazilyAllocated;
+
+    // Cost: missing preferred bits plus present avoided bits. Ties keep the driver's order,
+    // which the spec sorts best-first.
+    std::vector<std::pair<uint32_t, uint32_t>> scored;
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i) {
+        auto flags = m_memoryProperties.memoryTypes[i].propertyFlags;
+        if (!(typeBits & (1u << i)) || (flags & required) != required || (flags & excluded)) continue;
+        uint32_t cost = std::popcount(static_cast<uint32_t>(preferred & ~flags)) + std::popcount(static_cast<uint32_t>(avoided & flags));
+        scored.emplace_back(cost, i);
+    }
+    std::stable_sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<uint32_t> types;
+    for (const auto& [cost, type] : scored) types.push_back(type);
+    return types;
+}
+
+GpuAllocation GpuAllocator::allocate_impl(const vk::MemoryRequirements& requirements, MemoryUsage usage, bool optimal,
+                                          bool dedicated, const vk::MemoryDedicatedAllocateInfo* dedicatedInfo) {
+    if (m_device == nullptr) throw std::runtime_error("gpu allocator: used before init()");
+    auto types = candidate_types(requirements.memoryTypeBits, usage);
+    if (types.empty()) throw std::runtime_error("gpu allocator: no memory type fits the resource");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    dedicated = dedicated || requirements.size >= m_settings.dedicatedThreshold;
+
+    // 1. Walk the candidate types best-first; running out of one heap falls through to the next
+    for (uint32_t type : types) {
+        auto flags = m_memoryProperties.memoryTypes[type].propertyFlags;
+        bool hostVisible = static_cast<bool>(flags & vk::MemoryPropertyFlagBits::eHostVisible);
+
+        if (!dedicated) {
+            // 2. Non-coherent memory is flushed and invalidated in whole atoms, so a sub-allocation
+            // has to own every atom it touches or a flush would reach into its neighbours
+            vk::MemoryRequirements placement = requirements;
+            if (hostVisible && !(flags & vk::MemoryPropertyFlagBits::eHostCoherent)) {
+                placement.alignment = std::max(placement.alignment, m_nonCoherentAtomSize);
+                placement.size = align_up(placement.size, m_nonCoherentAtomSize);
+            }
+
+            // 3. Existing blocks first, then a new block, halved on failure down to the request size
+            Pool& pool = pool_for(type, optimal);
+            GpuAllocation allocation;
+            if (try_suballocate(pool, placement, allocation)) return allocation;
+
+            vk::DeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[type].heapIndex].size;
+            vk::DeviceSize blockSize = std::min(m_settings.blockSize, std::max<vk::DeviceSize>(heapSize / 8, placement.size));
+            while (blockSize >= placement.size) {
+                try {
+                    auto block = std::make_unique<Block>(allocate_memory(blockSize, type, nullptr), blockSize);
+                    if (hostVisible) block->mapped = static_cast<std::byte*>(block->memory.mapMemory(0, VK_WHOLE_SIZE));
+                    m_reserved += blockSize;
+                    m_heaps[heap_of(type)].reserved += blockSize;
+                    pool.blocks.push_back(std::move(block));
+                    break;
+                } catch (const vk::OutOfDeviceMemoryError&) {
+                    if (blockSize / 2 < placement.size) break;
+                    blockSize /= 2;
+                }
+            }
+            if (try_suballocate(pool, placement, allocation)) return allocation;
+            continue;
+        }
+
+        // 4. Dedicated: one VkDeviceMemory for this resource alone
+        try {
+            vk::raii::DeviceMemory memory = allocate_memory(requirements.size, type, dedicatedInfo);
+            Dedicated& entry = m_dedicated.emplace_back(Dedicated{ std::move(memory), requirements.size, type });
+
+            GpuAllocation allocation;
+            allocation.m_allocator = this;
+            allocation.m_owner = &entry;
+            allocation.m_memory = *entry.memory;
+            allocation.m_size = requirements.size;
+            allocation.m_memoryType = type;
+            if (hostVisible) allocation.m_mapped = entry.memory.mapMemory(0, VK_WHOLE_SIZE);
+            m_reserved += requirements.size;
+            m_heaps[heap_of(type)].reserved += requirements.size;
+            m_heaps[heap_of(type)].used += requirements.size;
+            m_used += requirements.size;
+            publish_metrics();
+            return allocation;
+        } catch (const vk::OutOfDeviceMemoryError&) {
+            continue;
+        }
+    }
+    throw std::runtime_error(std::format("gpu allocator: out of memory for {} bytes", requirements.size));
+}
+
+bool GpuAllocator::try_suballocate(Pool& pool, const vk::MemoryRequirements& requirements, GpuAllocation& out) {
+    // Newest blocks last; earlier ones are fuller and filling them first lets later ones drain
+    for (auto& block : pool.blocks) {
+        auto range = block->tlsf.allocate(requirements.size, requirements.alignment);
+        if (!range) continue;
+
+        out.m_allocator = this;
+        out.m_owner = block.get();
+        out.m_node = range->node;
+        out.m_memory = *block->memory;
+        out.m_offset = range->offset;
+        out.m_size = requirements.size;
+        out.m_mapped = block->mapped ? block->mapped + range->offset : nullptr;
+        out.m_memoryType = pool.memoryType;
+        m_used += range->size;
+        m_heaps[heap_of(pool.memoryType)].used += range->size;
+        publish_metrics();
+        return true;
+    }
+    return false;
+}
+
+vk::raii::DeviceMemory GpuAllocator::allocate_memory(vk::DeviceSize size, uint32_t memoryType, const void* pNext) {
+    if (m_deviceAllocations >= m_maxAllocations) {
+        throw std::runtime_error(std::format("gpu allocator: maxMemoryAllocationCount ({}) reached", m_maxAllocations));
+    }
+    vk::raii::DeviceMemory memory(*m_device, vk::MemoryAllocateInfo{
+        .pNext = pNext,
+        .allocationSize = size,
+        .memoryTypeIndex = memoryType
+    });
+    ++m_deviceAllocations;
+    return memory;
+}
+
+GpuAllocator::Pool& GpuAllocator::pool_for(uint32_t memoryType, bool optimal) {
+    // Without a granularity constraint linear and optimal resources can share blocks freely;
+    // with one, keeping them apart is cheaper than padding every neighbour pair
+    return m_pools[memoryType * 2 + (optimal && m_granularity > 1 ? 1 : 0)];
+}
+
+void GpuAllocator::release(GpuAllocation& allocation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (allocation.dedicated()) {
+        auto it = std::find_if(m_dedicated.begin(), m_dedicated.end(), [&](const Dedicated& d) { return &d == allocation.m_owner; });
+        if (it == m_dedicated.end()) return;
+        HeapStats& heap = m_heaps[heap_of(it->memoryType)];
+        m_reserved -= it->size;
+        m_used -= it->size;
+        heap.reserved -= it->size;
+        heap.used -= it->size;
+        heap.freed += it->size;
+        m_dedicated.erase(it);
+        --m_deviceAllocations;
+        publish_metrics();
+        return;
+    }
+
+    auto* block = static_cast<Block*>(allocation.m_owner);
+    uint64_t before = block->tlsf.used();
+    block->tlsf.free(allocation.m_node);
+    uint64_t freed = before - block->tlsf.used();
+    m_used -= freed;
+    HeapStats& heap = m_heaps[heap_of(allocation.memory_type())];
+    heap.used -= freed;
+    heap.freed += freed;
+
+    // Keep one empty block per pool as hysteresis against allocate/free churn; free the rest
+    if (block->tlsf.empty()) {
+        for (Pool& pool : m_pools) {
+            auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(), [&](const auto& b) { return b.get() == block; });
+            if (it == pool.blocks.end()) continue;
+            bool otherEmpty = std::any_of(pool.blocks.begin(), pool.blocks.end(),
+                [&](const auto& b) { return b.get() != block && b->tlsf.empty(); });
+            if (otherEmpty) {
+                m_reserved -= block->tlsf.capacity();
+                heap.reserved -= block->tlsf.capacity();
+                pool.blocks.erase(it);
+                --m_deviceAllocations;
+            }
+            break;
+        }
+    }
+    publish_metrics();
+}
+
+vk::MappedMemoryRange GpuAllocator::mapped_range(const GpuAllocation& allocation, vk::DeviceSize offset, vk::DeviceSize size) const {
+    vk::DeviceSize memorySize = allocation.dedicated() ? static_cast<const Dedicated*>(allocation.m_owner)->size
+                                                       : static_cast<const Block*>(allocation.m_owner)->tlsf.capacity();
+    vk::DeviceSize begin = allocation.offset() + offset;
+    vk::DeviceSize end = size == VK_WHOLE_SIZE ? allocation.offset() + allocation.size() : begin + size;
+
+    // Atom-aligned, clamped to the end of the memory object as the spec allows
+    begin = begin / m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+    end = std::min(align_up(end, m_nonCoherentAtomSize), memorySize);
+    return vk::MappedMemoryRange{ .memory = allocation.memory(), .offset = begin, .size = end - begin };
+}
+
+void GpuAllocator::flush(const GpuAllocation& allocation, vk::DeviceSize offset, vk::DeviceSize size) {
+    if (!allocation || !allocation.mapped()) return;
+    if (m_memoryProperties.memoryTypes[allocation.memory_type()].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent) return;
+    m_device->flushMappedMemoryRanges(mapped_range(allocation, offset, size));
+}
+
+void GpuAllocator::invalidate(const GpuAllocation& allocation, vk::DeviceSize offset, vk::DeviceSize size) {
+    if (!allocation || !allocation.mapped()) return;
+    if (m_memoryProperties.memoryTypes[allocation.memory_type()].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent) return;
+    m_device->invalidateMappedMemoryRanges(mapped_range(allocation, offset, size));
+}
+
+// --- Reporting ---
+
+GpuAllocator::HeapStats GpuAllocator::heap_stats(uint32_t heap) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return heap < m_heaps.size() ? m_heaps[heap] : HeapStats{};
+}
+
+GpuAllocator::Report GpuAllocator::report() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Report report;
+    for (const Pool& pool : m_pools) {
+        if (pool.blocks.empty()) continue;
+        PoolReport entry{
+            .memoryType = pool.memoryType,
+            .heap = m_memoryProperties.memoryTypes[pool.memoryType].heapIndex,
+            .optimal = pool.optimal
+        };
+        vk::DeviceSize freeBytes = 0;
+        for (const auto& block : pool.blocks) {
+            ++entry.blocks;
+            entry.reserved += block->tlsf.capacity();
+            entry.used += block->tlsf.used();
+            entry.largestFree = std::max(entry.largestFree, block->tlsf.largest_free());
+            entry.allocations += block->tlsf.allocation_count();
+            entry.freeRanges += block->tlsf.free_range_count();
+            freeBytes += block->tlsf.capacity() - block->tlsf.used();
+        }
+        entry.fragmentation = freeBytes > 0 ? 1.0 - static_cast<double>(entry.largestFree) / static_cast<double>(freeBytes) : 0.0;
+        report.pools.push_back(entry);
+    }
+    for (const Dedicated& dedicated : m_dedicated) {
+        ++report.dedicatedAllocations;
+        report.dedicatedBytes += dedicated.size;
+    }
+    report.deviceAllocations = m_deviceAllocations;
+    report.maxDeviceAllocations = m_maxAllocations;
+    report.reserved = m_reserved;
+    report.used = m_used;
+    return report;
+}
+
+void GpuAllocator::print_report() const {
+    Report r = report();
+    std::println("gpu memory: {:.1f} / {:.1f} MiB used in {} device allocation(s) (limit {}), {} dedicated ({:.1f} MiB)",
+        static_cast<double>(r.used) / MIB, static_cast<double>(r.reserved) / MIB, r.deviceAllocations, r.maxDeviceAllocations,
+        r.dedicatedAllocations, static_cast<double>(r.dedicatedBytes) / MIB);
+    for (const PoolReport& pool : r.pools) {
+        std::println("  type {} heap {}{}: {} block(s), {:.1f} / {:.1f} MiB, {} allocation(s), {} free range(s), largest {:.1f} MiB, fragmentation {:.0f}%",
+            pool.memoryType, pool.heap, pool.optimal ? " (optimal)" : "", pool.blocks,
+            static_cast<double>(pool.used) / MIB, static_cast<double>(pool.reserved) / MIB, pool.allocations, pool.freeRanges,
+            static_cast<double>(pool.largestFree) / MIB, pool.fragmentation * 100.0);
+    }
+}
+
+void GpuAllocator::publish_metrics() {
+    m_reservedGauge.set(static_cast<double>(m_reserved));
+    m_usedGauge.set(static_cast<double>(m_used));
+    m_allocationsGauge.set(static_cast<double>(m_deviceAllocations));
+}
+
+} // namespace Zeta
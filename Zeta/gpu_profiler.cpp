@@ -0,0 +1,162 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/gpu_profiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <print>
+
+namespace Zeta {
+
+GpuProfiler::Scope::Scope(GpuProfiler* profiler, const vk::raii::CommandBuffer& cmd, const char* name)
+    : m_profiler(profiler), m_cmd(cmd) {
+    m_index = m_profiler->begin_scope(m_cmd, name);
+}
+
+GpuProfiler::Scope::~Scope() {
+    if (m_index >= 0) m_profiler->end_scope(m_cmd, m_index);
+}
+
+void GpuProfiler::init(const vk::raii::Device& device, float timestampPeriod, uint32_t timestampValidBits, uint32_t framesInFlight) {
+    m_slots.clear();
+    m_current = nullptr;
+
+    // 1. Queues without timestamp support report 0 valid bits, leave the profiler disabled
+    if (timestampValidBits == 0) {
+        std::println("gpu profiler: queue family has no timestamp support, disabled");
+        return;
+    }
+
+    m_msPerTick = static_cast<double>(timestampPeriod) / 1.0e6;
+    m_tickMask = timestampValidBits >= 64 ? ~0ull : ((1ull << timestampValidBits) - 1);
+
+    // 2. One pool per frame-in-flight slot, two queries per scope
+    vk::QueryPoolCreateInfo poolInfo{
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = MAX_SCOPES * 2
+    };
+
+    m_slots.resize(framesInFlight);
+    for (auto& slot : m_slots) {
+        slot.pool = vk::raii::QueryPool(device, poolInfo);
+        slot.scopes.reserve(MAX_SCOPES);
+    }
+}
+
+void GpuProfiler::begin_frame(const vk::raii::CommandBuffer& cmd, uint32_t slotIndex, uint64_t frameValue, uint64_t completedValue) {
+    if (!enabled()) return;
+
+    // 1. Harvest any slot the GPU has finished with (never blocks: the timeline says it's done)
+    for (auto& slot : m_slots) {
+        if (slot.pending && slot.frameValue <= completedValue) {
+            resolve(slot);
+        }
+    }
+
+    // 2. Recycle this slot's pool for the new frame
+    Slot& slot = m_slots[slotIndex % m_slots.size()];
+    if (slot.pending) {
+        // Caller didn't wait for this slot's previous frame; drop its data rather than stall
+        slot.pending = false;
+    }
+    cmd.resetQueryPool(*slot.pool, 0, MAX_SCOPES * 2);
+    slot.scopes.clear();
+    slot.queryCount = 0;
+    slot.frameValue = frameValue;
+    slot.pending = true;
+    m_current = &slot;
+}
+
+int32_t GpuProfiler::begin_scope(const vk::raii::CommandBuffer& cmd, const char* name) {
+    if (!m_current || m_current->scopes.size() >= MAX_SCOPES) return -1;
+
+    ScopeRecord record{
+        .name = name,
+        .beginQuery = m_current->queryCount++,
+        .endQuery = 0
+    };
+    cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, *m_current->pool, record.beginQuery);
+    m_current->scopes.push_back(record);
+    return static_cast<int32_t>(m_current->scopes.size() - 1);
+}
+
+void GpuProfiler::end_scope(const vk::raii::CommandBuffer& cmd, int32_t index) {
+    if (!m_current) return;
+
+    ScopeRecord& record = m_current->scopes[index];
+    record.endQuery = m_current->queryCount++;
+    cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, *m_current->pool, record.endQuery);
+}
+
+void GpuProfiler::resolve(Slot& slot) {
+    slot.pending = false;
+    if (slot.queryCount == 0) return;
+
+    // 64-bit results, no WAIT flag: the frame timeline already guaranteed availability
+    auto [result, ticks] = slot.pool.getResults<uint64_t>(
+        0, slot.queryCount, slot.queryCount * sizeof(uint64_t), sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess) return;
+
+    GpuFrameTiming frame{ .frame = slot.frameValue };
+    frame.passes.reserve(slot.scopes.size());
+
+    uint64_t first = UINT64_MAX;
+    uint64_t last = 0;
+    for (const auto& scope : slot.scopes) {
+        if (scope.endQuery == 0) continue; // Scope never closed
+        first = std::min(first, ticks[scope.beginQuery] & m_tickMask);
+        last = std::max(last, ticks[scope.endQuery] & m_tickMask);
+    }
+    if (first == UINT64_MAX) return;
+
+    for (const auto& scope : slot.scopes) {
+        if (scope.endQuery == 0) continue;
+        uint64_t begin = ticks[scope.beginQuery] & m_tickMask;
+        uint64_t end = ticks[scope.endQuery] & m_tickMask;
+        frame.passes.push_back({
+            .name = scope.name,
+            .beginTicks = begin,
+            .startMs = static_cast<double>(begin - first) * m_msPerTick,
+            .durationMs = end > begin ? static_cast<double>(end - begin) * m_msPerTick : 0.0
+        });
+    }
+    frame.totalMs = static_cast<double>(last - first) * m_msPerTick;
+
+    m_latest = frame;
+    m_history.push_back(std::move(frame));
+    if (m_history.size() > HISTORY_FRAMES) m_history.pop_front();
+}
+
+double GpuProfiler::pass_ms(std::string_view name) const {
+    for (const auto& pass : m_latest.passes) {
+        if (name == pass.name) return pass.durationMs;
+    }
+    return 0.0;
+}
+
+bool GpuProfiler::write_chrome_trace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    // Timestamps are GPU ticks, rebased to the oldest frame we still have
+    uint64_t base = UINT64_MAX;
+    for (const auto& frame : m_history) {
+        for (const auto& pass : frame.passes) base = std::min(base, pass.beginTicks);
+    }
+
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& frame : m_history) {
+        for (const auto& pass : frame.passes) {
+            double tsUs = static_cast<double>(pass.beginTicks - base) * m_msPerTick * 1000.0;
+            file << (first ? "" : ",")
+                 << "{\"name\":\"" << pass.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":\"GPU\""
+                 << ",\"ts\":" << tsUs << ",\"dur\":" << pass.durationMs * 1000.0
+                 << ",\"args\":{\"frame\":" << frame.frame << "}}";
+            first = false;
+        }
+    }
+    file << "],\"displayTimeUnit\":\"ms\"}\n";
+    return file.good();
+}
+
+} // namespace Zeta
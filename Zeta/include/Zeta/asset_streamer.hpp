@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Zeta/metrics.hpp"
+#include "Zeta/transfer_queue.hpp"
+
+namespace Zeta {
+
+// Lower values are dispatched first; requests of equal priority go in submission order
+enum class StreamPriority : uint8_t { Critical, High, Normal, Low };
+
+// Reads file ranges straight into TransferQueue's persistently mapped staging ring, off the frame
+// thread. With liburing (ZETA_HAVE_IO_URING) one thread drives an io_uring; otherwise, or when the
+// kernel refuses a ring, a few reader threads use pread. Dispatch honours priorities, a
+// bytes-in-flight cap and an optional read bandwidth. Finished requests are handed back to the
+// frame thread in update(), where the callback can copy() the staging slice to its destination.
+class AssetStreamer {
+public:
+    using RequestId = uint64_t; // 0 is never a valid id
+
+    enum class Status : uint8_t { Done, Failed, Cancelled };
+
+    struct Completion {
+        RequestId id = 0;
+        Status status = Status::Failed;
+        std::string path;
+        TransferQueue::Staging staging; // The file's bytes when Done; released after the callback unless copied
+        std::string error;
+    };
+    // Runs on the frame thread, inside update()
+    using Callback = std::function<void(const Completion&)>;
+
+    struct Request {
+        std::string path;
+        uint64_t offset = 0;
+        uint64_t size = 0; // 0: to the end of the file
+        StreamPriority priority = StreamPriority::Normal;
+        Callback onComplete;
+    };
+
+    struct Settings {
+        uint64_t maxBytesInFlight = 32ull << 20; // One request larger than this still runs, alone
+        uint32_t maxRequestsInFlight = 32;
+        uint64_t bytesPerSecond = 0;             // Read bandwidth cap; 0 for none
+        uint32_t fallbackThreads = 2;
+        bool useIoUring = true;
+    };
+
+    struct Stats {
+        uint32_t queued = 0;
+        uint32_t inFlight = 0;
+        uint64_t bytesInFlight = 0;
+    };
+
+    ~AssetStreamer();
+
+    void init(TransferQueue& transfer, const Settings& settings);
+    void init(TransferQueue& transfer) { init(transfer, Settings{}); }
+    // Stops the I/O threads after in-flight reads land. Callbacks of unfinished requests never run.
+    void shutdown();
+    bool uses_io_uring() const { return m_ring != nullptr; }
+
+    // Any thread; never touches the disk
+    RequestId request(Request request);
+    // Whatever stage the request is in, its callback runs with Status::Cancelled unless it already
+    // ran. Returns false for unknown or already delivered requests.
+    bool cancel(RequestId id);
+
+    // Frame thread, once per frame: runs the callbacks of every request finished since the last call
+    size_t update();
+
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        RequestId id;
+        uint64_t seq;
+        Request request;
+        Clock::time_point submitted;
+        int fd = -1;
+        uint64_t size = 0;
+        uint64_t done = 0;
+        TransferQueue::Staging staging;
+        bool dispatched = false;         // Taken by an I/O thread (guarded by m_mutex)
+        std::atomic<bool> cancelled{false};
+    };
+    struct Finished {
+        Completion completion;
+        Callback callback;
+        Clock::time_point submitted;
+    };
+    struct QueueEntry {
+        StreamPriority priority;
+        uint64_t seq;
+        RequestId id;
+        bool operator<(const QueueEntry& o) const {
+            // std::priority_queue pops the largest: invert so the lowest priority value and seq win
+            return priority != o.priority ? priority > o.priority : seq > o.seq;
+        }
+    };
+    enum class Prepare : uint8_t { Ready, Retry, Failed };
+
+    Pending* next_request(std::unique_lock<std::mutex>& lock);
+    Prepare prepare(Pending& pending, std::string& error);
+    // Back into the queue after Retry (the file is reopened next time), or finished if cancelled
+    void requeue(Pending& pending);
+    void finish(Pending& pending, Status status, std::string error = {});
+    std::chrono::microseconds backoff() const;
+
+    void reader_loop(std::stop_token stop);
+    void ring_loop(std::stop_token stop);
+    bool submit_read(Pending& pending);
+
+    TransferQueue* m_transfer = nullptr;
+    Settings m_settings;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    std::unordered_map<RequestId, std::unique_ptr<Pending>> m_requests;
+    std::priority_queue<QueueEntry> m_queue;
+    std::vector<Finished> m_finished;
+    RequestId m_nextId = 1;
+    uint64_t m_nextSeq = 0;
+    uint32_t m_inFlight = 0;
+    uint64_t m_bytesInFlight = 0;
+    double m_tokens = 0.0;              // Bandwidth budget, in bytes
+    Clock::time_point m_lastRefill;
+
+    void* m_ring = nullptr;             // io_uring; set in init(), torn down in shutdown()
+    uint32_t m_ringReads = 0;           // Reads submitted and not yet reaped (ring thread only)
+    std::vector<std::jthread> m_threads;
+
+    Counter& m_requestCount = Metrics::get().counter("stream_requests");
+    Counter& m_completed = Metrics::get().counter("stream_completed");
+    Counter& m_failed = Metrics::get().counter("stream_failed");
+    Counter& m_cancelled = Metrics::get().counter("stream_cancelled");
+    Counter& m_bytesRead = Metrics::get().counter("stream_bytes_read");
+    Gauge& m_bytesInFlightGauge = Metrics::get().gauge("stream_bytes_in_flight");
+    Gauge& m_queueDepth = Metrics::get().gauge("stream_queue_depth");
+    Histogram& m_latency = Metrics::get().histogram("stream_latency_us");
+};
+
+} // namespace Zeta
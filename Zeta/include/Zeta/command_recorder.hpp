@@ -0,0 +1,77 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace Zeta {
+
+// Records one dynamic-rendering pass as secondary command buffers on several threads.
+// Every thread owns a transient command pool per frame-in-flight slot, so recording never
+// shares a pool and a slot is recycled with one vkResetCommandPool per thread.
+class ParallelRecorder {
+public:
+    // Records chunk `chunk` into `cmd` (already begun, inside the pass). Must not touch shared state.
+    using RecordFn = std::function<void(const vk::raii::CommandBuffer& cmd, uint32_t chunk)>;
+
+    ~ParallelRecorder();
+
+    // threadCount includes the calling thread, which records chunks too
+    void init(const vk::raii::Device& device, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t framesInFlight);
+    void shutdown();
+
+    bool enabled() const { return !m_threads.empty(); }
+    uint32_t thread_count() const { return static_cast<uint32_t>(m_threads.size()); }
+
+    // Call once the slot's previous frame has completed on the GPU
+    void begin_frame(uint32_t slot);
+
+    // Records chunkCount secondaries for a pass rendering to `rendering`'s formats and returns them in
+    // chunk order, whichever thread recorded each, so executeCommands replays deterministically.
+    // The span is valid until the next record() call.
+    std::span<const vk::CommandBuffer> record(uint32_t chunkCount, const vk::CommandBufferInheritanceRenderingInfo& rendering, const RecordFn& fn);
+
+private:
+    struct SlotPool {
+        vk::raii::CommandPool pool{nullptr};
+        std::vector<vk::raii::CommandBuffer> buffers;
+        uint32_t used = 0;
+    };
+
+    struct ThreadState {
+        std::vector<SlotPool> slots;
+        std::jthread thread; // Empty for index 0, the calling thread
+    };
+
+    void worker_loop(std::stop_token stop, uint32_t index);
+    void record_chunks(uint32_t index);
+    vk::raii::CommandBuffer& next_buffer(ThreadState& state);
+
+    const vk::raii::Device* m_device = nullptr;
+    std::vector<std::unique_ptr<ThreadState>> m_threads;
+    uint32_t m_slot = 0;
+
+    // Current job, published under m_mutex by bumping m_generation
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    uint64_t m_generation = 0;
+    uint32_t m_running = 0;
+    std::atomic<uint32_t> m_nextChunk{0};
+    uint32_t m_chunkCount = 0;
+    const RecordFn* m_fn = nullptr;
+    vk::CommandBufferInheritanceInfo m_inheritance{};
+    vk::CommandBufferInheritanceRenderingInfo m_rendering{};
+    std::exception_ptr m_error;
+
+    std::vector<vk::CommandBuffer> m_results;
+};
+
+} // namespace Zeta
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Zeta {
+
+// Keeps vk::raii objects (or any movable owner) alive until the GPU timeline reaches the value
+// they were retired at, so resources still referenced by in-flight frames can be dropped without waitIdle().
+// Objects retired with the same value are destroyed in the order they were retired.
+class DeletionQueue {
+public:
+    template<typename T>
+    void retire(uint64_t timelineValue, T&& object) {
+        m_entries.push_back({ timelineValue, std::make_unique<Holder<std::decay_t<T>>>(std::forward<T>(object)) });
+    }
+
+    // Destroys everything retired at or before completedValue, returns how many objects were freed
+    size_t collect(uint64_t completedValue) {
+        size_t freed = 0;
+        for (auto& entry : m_entries) {
+            if (entry.value <= completedValue) {
+                entry.holder.reset();
+                ++freed;
+            }
+        }
+        if (freed > 0) {
+            std::erase_if(m_entries, [](const Entry& e) { return !e.holder; });
+        }
+        return freed;
+    }
+
+    // Destroys everything immediately. Only safe once the device is idle.
+    void flush() {
+        for (auto& entry : m_entries) entry.holder.reset();
+        m_entries.clear();
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct HolderBase {
+        virtual ~HolderBase() = default;
+    };
+
+    template<typename T>
+    struct Holder : HolderBase {
+        explicit Holder(T&& o) : object(std::move(o)) {}
+        T object;
+    };
+
+    struct Entry {
+        uint64_t value;
+        std::unique_ptr<HolderBase> holder;
+    };
+
+    std::vector<Entry> m_entries;
+};
+
+} // namespace Zeta
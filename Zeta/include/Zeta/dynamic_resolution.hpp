@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include "Zeta/metrics.hpp"
+
+namespace Zeta {
+
+// Picks the render scale that holds the GPU frame time at a target. Pixel cost grows with the
+// square of the scale, so the correction is sqrt(target / measured). Drops are applied at once
+// (a missed budget is visible), raises are small and need clear headroom, and after every change
+// the controller waits out the frames still in flight before judging the new scale.
+class DynamicResolution {
+public:
+    struct Settings {
+        double targetMs = 0.0;     // GPU frame budget; 0 disables
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        uint32_t cooldownFrames = 8;
+    };
+
+    void configure(const Settings& settings);
+    bool enabled() const { return m_settings.targetMs > 0.0; }
+    const Settings& settings() const { return m_settings; }
+
+    // Feeds the GPU time of a resolved frame (repeats of the same frame are ignored) and returns
+    // the scale to render the next frame at
+    float update(uint64_t frame, double gpuMs);
+    float scale() const { return m_scale; }
+    double filtered_ms() const { return m_filteredMs; }
+
+private:
+    static constexpr double FILTER_ALPHA = 0.2;  // EWMA weight of the newest sample
+    static constexpr double RAISE_BELOW = 0.85;  // Raise only under 85% of the budget
+    static constexpr float MAX_DROP = 0.25f;     // Per decision, relative
+    static constexpr float MAX_RAISE = 0.05f;
+    static constexpr float QUANTUM = 1.0f / 64.0f; // Keeps sub-pixel jitter from moving the extent
+
+    Settings m_settings;
+    float m_scale = 1.0f;
+    double m_filteredMs = 0.0;
+    uint64_t m_lastFrame = 0;
+    uint64_t m_lastChangeFrame = 0;
+
+    Gauge& m_scaleGauge = Metrics::get().gauge("drs_scale");
+    Gauge& m_gpuMsGauge = Metrics::get().gauge("drs_gpu_ms");
+    Gauge& m_targetGauge = Metrics::get().gauge("drs_target_ms");
+    Counter& m_drops = Metrics::get().counter("drs_scale_drops");
+    Counter& m_raises = Metrics::get().counter("drs_scale_raises");
+};
+
+} // namespace Zeta
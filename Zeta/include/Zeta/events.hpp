@@ -1,39 +1,375 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
-#include <mutex>
-#include <queue>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
 #include <variant>
 
 namespace Zeta {
 
-struct QuitEvent {};
-struct ResizeEvent { uint32_t w, h; };
-struct KeyEvent { uint32_t key; bool pressed; };
+// Per-frame coalescing rule, opted into by declaring `static constexpr Coalesce coalesce` on an event type.
+// Only drain_coalesced() applies these, drain()/poll() always deliver every event.
+enum class Coalesce {
+    None,     // Deliver every event (default for types that don't declare a rule)
+    KeepLast, // Only the newest event of this type per frame survives
+    Merge,    // Fold all events of this type into one via `void merge(const T& later)`
+    Dedupe    // Drop an event equal to the previous one with the same `dedupe_key()` this frame
+};
+
+template<typename T>
+consteval Coalesce coalesce_rule() {
+    if constexpr (requires { { T::coalesce } -> std::convertible_to<Coalesce>; }) {
+        return T::coalesce;
+    } else {
+        return Coalesce::None;
+    }
+}
+
+// Event timestamps are CLOCK_MONOTONIC nanoseconds (steady_clock on Linux), 0 when unknown.
+// Input events carry the compositor's own event time, so they say when the user acted rather
+// than when we got around to reading the socket.
+inline uint64_t event_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Merged events keep the earliest timestamp: latency is measured from the first input folded in
+inline uint64_t earliest_time(uint64_t a, uint64_t b) {
+    return (a == 0 || (b != 0 && b < a)) ? b : a;
+}
+
+struct QuitEvent {
+    uint64_t time = 0;
+};
+struct ResizeEvent {
+    uint32_t w, h;
+    uint64_t time = 0;
+    static constexpr Coalesce coalesce = Coalesce::KeepLast;
+};
+struct KeyEvent {
+    uint32_t key; bool pressed;
+    uint64_t time = 0;
+    static constexpr bool is_input = true;
+    static constexpr Coalesce coalesce = Coalesce::Dedupe;
+    uint32_t dedupe_key() const { return key; }
+    // Same key state is a duplicate whenever it arrived
+    bool operator==(const KeyEvent& o) const { return key == o.key && pressed == o.pressed; }
+};
+// Relative (unaccelerated when the compositor offers it) motion, for camera-style input
+struct PointerMotionEvent {
+    double dx, dy;
+    uint64_t time = 0;
+    static constexpr bool is_input = true;
+    static constexpr Coalesce coalesce = Coalesce::Merge;
+    void merge(const PointerMotionEvent& later) { dx += later.dx; dy += later.dy; time = earliest_time(time, later.time); }
+};
+// Absolute cursor position in surface-local coordinates
+struct PointerPositionEvent {
+    double x, y;
+    uint64_t time = 0;
+    static constexpr bool is_input = true;
+    static constexpr Coalesce coalesce = Coalesce::Merge;
+    void merge(const PointerPositionEvent& later) { x = later.x; y = later.y; time = earliest_time(time, later.time); }
+};
+struct PointerButtonEvent {
+    uint32_t button; bool pressed;
+    uint64_t time = 0;
+    static constexpr bool is_input = true;
+};
 
 // The "Base" variant that Zeta knows how to process
-using CoreEvent = std::variant<QuitEvent, ResizeEvent, KeyEvent>;
+using CoreEvent = std::variant<QuitEvent, ResizeEvent, KeyEvent, PointerMotionEvent, PointerPositionEvent, PointerButtonEvent>;
+
+// Timestamp of a user-input event (one declaring `static constexpr bool is_input`), 0 for anything else.
+// Works on any variant built from these types, e.g. an app's own event variant.
+template<typename Variant>
+uint64_t input_time(const Variant& e) {
+    return std::visit([](const auto& ev) -> uint64_t {
+        if constexpr (requires { requires std::remove_cvref_t<decltype(ev)>::is_input; }) return ev.time;
+        else return 0;
+    }, e);
+}
 
+// What push() does when the ring is full
+enum class OverflowPolicy {
+    Drop,      // Reject the new event, push() returns false
+    Overwrite, // Discard the oldest pending event to make room
+    Block      // Spin/yield until the consumer frees a slot. A push from the consumer thread itself
+               // (e.g. Wayland callbacks inside poll_events() without the input thread) can never
+               // be unblocked, so it is dropped instead and counted as such.
+};
+
+struct EventBusStats {
+    uint64_t pushed = 0;      // Events accepted into the ring
+    uint64_t dropped = 0;     // Events rejected because the ring was full (Drop, or Block on the consumer thread)
+    uint64_t overwritten = 0; // Pending events discarded to make room (Overwrite)
+    uint64_t blocked = 0;     // Pushes that had to wait for space (Block)
+    uint64_t highWater = 0;   // Deepest the ring has been since construction
+    uint64_t coalesced = 0;   // Events folded away by KeepLast/Merge rules in drain_coalesced()
+    uint64_t deduped = 0;     // Events removed by Dedupe rules in drain_coalesced()
+};
 
-template<typename EventVariant>
+// Bounded lock-free multi-producer/single-consumer ring (Vyukov-style sequenced cells).
+// Any thread may push(); only one thread may poll()/drain()/poll_batch().
+template<typename EventVariant, size_t Capacity = 1024, OverflowPolicy Policy = OverflowPolicy::Drop>
 class EventBus {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "EventBus capacity must be a power of two");
+    static_assert(std::is_default_constructible_v<EventVariant>, "EventBus slots are pre-constructed");
+
 public:
-    void push(EventVariant e) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_queue.push(std::move(e));
+    EventBus() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    // Returns false only when the policy is Drop and the ring is full
+    bool push(EventVariant e) {
+        bool waited = false;
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+
+        for (;;) {
+            Cell& cell = m_cells[pos & Mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                // 1. Slot is free for this ticket, try to claim it
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(e);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    record_push(pos + 1);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // 2. Slot still holds an unconsumed event from the previous lap: ring is full
+                if constexpr (Policy == OverflowPolicy::Drop) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else if constexpr (Policy == OverflowPolicy::Overwrite) {
+                    if (try_pop_into(nullptr)) m_overwritten.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    // Waiting on ourselves would never end
+                    if (m_consumer.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    if (!waited) m_blocked.fetch_add(1, std::memory_order_relaxed);
+                    waited = true;
+                    std::this_thread::yield();
+                }
+                pos = m_tail.load(std::memory_order_relaxed);
+            } else {
+                // 3. Another producer took this ticket, reload
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
     }
 
     std::optional<EventVariant> poll() {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_queue.empty()) return std::nullopt;
-        
-        EventVariant e = std::move(m_queue.front());
-        m_queue.pop();
+        note_consumer();
+        EventVariant e;
+        if (!try_pop_into(&e)) return std::nullopt;
         return e;
     }
 
+    // Invokes cb(EventVariant&) for every event pending at the time of the call.
+    // Events pushed while draining are left for the next drain so a busy producer can't livelock the consumer.
+    template<typename Callback>
+    size_t drain(Callback&& cb) {
+        note_consumer();
+        size_t budget = size();
+        size_t count = 0;
+        EventVariant e;
+        while (count < budget && try_pop_into(&e)) {
+            cb(e);
+            ++count;
+        }
+        return count;
+    }
+
+    // Like drain(), but first applies each event type's Coalesce rule to the batch so the
+    // callback sees at most one KeepLast/Merge event per type per call. Surviving events keep
+    // the position of the last event they absorbed, so relative ordering is preserved.
+    template<typename Callback>
+    size_t drain_coalesced(Callback&& cb) {
+        size_t count = poll_batch(m_scratch);
+
+        // 1. Fold the batch in place, remembering the last surviving index per alternative
+        std::array<size_t, std::variant_size_v<EventVariant>> last;
+        last.fill(SIZE_MAX);
+        // Bumping the epoch empties the dedupe table without touching it
+        if (++m_dedupeEpoch == 0) {
+            m_dedupeSlots.fill({});
+            m_dedupeEpoch = 1;
+        }
+        uint64_t coalesced = 0;
+        uint64_t deduped = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            m_keep[i] = true;
+            size_t type = m_scratch[i].index();
+            std::visit([&]<typename T>(T& cur) {
+                constexpr Coalesce rule = coalesce_rule<T>();
+                if constexpr (rule == Coalesce::KeepLast || rule == Coalesce::Merge) {
+                    if (last[type] != SIZE_MAX) {
+                        if constexpr (rule == Coalesce::Merge) {
+                            T folded = std::get<T>(m_scratch[last[type]]);
+                            folded.merge(cur);
+                            cur = folded;
+                        }
+                        m_keep[last[type]] = false;
+                        ++coalesced;
+                    }
+                    last[type] = i;
+                } else if constexpr (rule == Coalesce::Dedupe) {
+                    uint64_t key = (static_cast<uint64_t>(type) << 32) | cur.dedupe_key();
+                    DedupeSlot& slot = dedupe_slot(key);
+                    if (slot.epoch == m_dedupeEpoch && std::get<T>(m_scratch[slot.index]) == cur) {
+                        m_keep[i] = false;
+                        ++deduped;
+                    } else {
+                        slot = { key, i, m_dedupeEpoch };
+                    }
+                }
+            }, m_scratch[i]);
+        }
+
+        // 2. Deliver the survivors in order
+        size_t delivered = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!m_keep[i]) continue;
+            cb(m_scratch[i]);
+            ++delivered;
+        }
+
+        m_coalesced.fetch_add(coalesced, std::memory_order_relaxed);
+        m_deduped.fetch_add(deduped, std::memory_order_relaxed);
+        return delivered;
+    }
+
+    // Moves up to out.size() pending events into out, returns how many were written
+    size_t poll_batch(std::span<EventVariant> out) {
+        note_consumer();
+        size_t count = 0;
+        while (count < out.size() && try_pop_into(&out[count])) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Approximate number of pending events (exact when producers are quiet)
+    size_t size() const {
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        size_t head = m_head.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : 0;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    EventBusStats stats() const {
+        return {
+            .pushed = m_pushed.load(std::memory_order_relaxed),
+            .dropped = m_dropped.load(std::memory_order_relaxed),
+            .overwritten = m_overwritten.load(std::memory_order_relaxed),
+            .blocked = m_blocked.load(std::memory_order_relaxed),
+            .highWater = m_highWater.load(std::memory_order_relaxed),
+            .coalesced = m_coalesced.load(std::memory_order_relaxed),
+            .deduped = m_deduped.load(std::memory_order_relaxed)
+        };
+    }
+
 private:
-    std::queue<EventVariant> m_queue;
-    std::mutex m_mutex;
+    static constexpr size_t Mask = Capacity - 1;
+    // Keep the producer and consumer cursors on separate cache lines
+    static constexpr size_t CacheLine = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        EventVariant value;
+    };
+
+    // Open-addressed (linear probing) table of the last event index per dedupe key. Twice the
+    // ring's size, so one batch fills it at most halfway and probes always end.
+    struct DedupeSlot {
+        uint64_t key = 0;
+        size_t index = 0;
+        uint32_t epoch = 0; // Live only when equal to m_dedupeEpoch
+    };
+    static constexpr size_t DedupeMask = Capacity * 2 - 1;
+
+    DedupeSlot& dedupe_slot(uint64_t key) {
+        size_t pos = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & DedupeMask;
+        while (m_dedupeSlots[pos].epoch == m_dedupeEpoch && m_dedupeSlots[pos].key != key) {
+            pos = (pos + 1) & DedupeMask;
+        }
+        return m_dedupeSlots[pos];
+    }
+
+    // The head is advanced with a CAS rather than a plain store because in Overwrite mode
+    // producers also retire the oldest cell when the ring is full.
+    bool try_pop_into(EventVariant* out) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & Mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    if (out) *out = std::move(cell.value);
+                    cell.sequence.store(pos + Capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty (or the producer for this cell hasn't published yet)
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Block-policy buses remember who consumes, so a push from that thread never waits on itself
+    void note_consumer() {
+        if constexpr (Policy == OverflowPolicy::Block) m_consumer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+
+    void record_push(size_t newTail) {
+        m_pushed.fetch_add(1, std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t depth = newTail > head ? newTail - head : 0;
+        uint64_t seen = m_highWater.load(std::memory_order_relaxed);
+        while (depth > seen && !m_highWater.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    }
+
+    alignas(CacheLine) std::atomic<size_t> m_tail{0};
+    alignas(CacheLine) std::atomic<size_t> m_head{0};
+    alignas(CacheLine) std::array<Cell, Capacity> m_cells;
+
+    // Counters (relaxed, diagnostic only)
+    alignas(CacheLine) std::atomic<uint64_t> m_pushed{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_overwritten{0};
+    std::atomic<uint64_t> m_blocked{0};
+    std::atomic<std::thread::id> m_consumer{}; // Last thread to poll/drain (Block policy only)
+    std::atomic<uint64_t> m_highWater{0};
+    std::atomic<uint64_t> m_coalesced{0};
+    std::atomic<uint64_t> m_deduped{0};
+
+    // Consumer-only scratch for drain_coalesced(), reused every frame
+    std::array<EventVariant, Capacity> m_scratch;
+    std::array<bool, Capacity> m_keep;
+    std::array<DedupeSlot, Capacity * 2> m_dedupeSlots{};
+    uint32_t m_dedupeEpoch = 0;
 };
 
 
@@ -41,8 +377,8 @@ template<typename T>
 class InputHandler {
 public:
     InputHandler(EventBus<T>& bus) : m_bus(bus) {}
-    void on_key_callback(uint32_t key, bool pressed) {
-        m_bus.push(KeyEvent{key, pressed});
+    void on_key_callback(uint32_t key, bool pressed, uint64_t time = 0) {
+        m_bus.push(KeyEvent{key, pressed, time ? time : event_clock_ns()});
     }
 private:
     EventBus<T>& m_bus;
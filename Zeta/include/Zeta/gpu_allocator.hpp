@@ -0,0 +1,183 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Zeta/metrics.hpp"
+#include "Zeta/tlsf.hpp"
+
+namespace Zeta {
+
+// What the CPU does with the memory; picks the memory type
+enum class MemoryUsage : uint8_t {
+    GpuOnly,  // DEVICE_LOCAL, host-visible types avoided
+    Upload,   // HOST_VISIBLE, persistently mapped; CPU writes, GPU reads (coherent preferred)
+    Readback  // HOST_VISIBLE, persistently mapped; GPU writes, CPU reads (cached preferred)
+};
+
+class GpuAllocator;
+
+// Move-only owner of a range of device memory, returned to the allocator when destroyed.
+// Retire it through DeletionQueue like any vk::raii object when frames may still use it.
+class GpuAllocation {
+public:
+    GpuAllocation() = default;
+    GpuAllocation(std::nullptr_t) {}
+    GpuAllocation(GpuAllocation&& other) noexcept { *this = std::move(other); }
+    GpuAllocation& operator=(GpuAllocation&& other) noexcept;
+    GpuAllocation(const GpuAllocation&) = delete;
+    GpuAllocation& operator=(const GpuAllocation&) = delete;
+    ~GpuAllocation() { reset(); }
+
+    void reset();
+    explicit operator bool() const { return m_allocator != nullptr; }
+
+    vk::DeviceMemory memory() const { return m_memory; }
+    vk::DeviceSize offset() const { return m_offset; }
+    vk::DeviceSize size() const { return m_size; }
+    // Persistent mapping of this range, nullptr unless the memory is host-visible
+    void* mapped() const { return m_mapped; }
+    uint32_t memory_type() const { return m_memoryType; }
+    bool dedicated() const { return m_node == Tlsf::INVALID; }
+
+private:
+    friend class GpuAllocator;
+    GpuAllocator* m_allocator = nullptr;
+    void* m_owner = nullptr; // Block or dedicated allocation
+    uint32_t m_node = Tlsf::INVALID;
+    vk::DeviceMemory m_memory;
+    vk::DeviceSize m_offset = 0;
+    vk::DeviceSize m_size = 0;
+    void* m_mapped = nullptr;
+    uint32_t m_memoryType = 0;
+};
+
+// Sub-allocates resources from large per-memory-type blocks with a TLSF allocator, so the
+// vkAllocateMemory count stays far below maxMemoryAllocationCount and freed ranges coalesce.
+//  - Resources at least dedicatedThreshold bytes, or ones the driver asks to be dedicated, get
+//    their own VkDeviceMemory (VK_KHR_dedicated_allocation is core in 1.1)
+//  - When bufferImageGranularity > 1, linear and optimal resources live in separate blocks
+//    rather than being padded apart inside one
+//  - Host-visible blocks are mapped once, for their whole lifetime
+// All entry points are thread-safe.
+class GpuAllocator {
+public:
+    struct Settings {
+        vk::DeviceSize blockSize = 256ull << 20; // Capped at 1/8 of small heaps
+        vk::DeviceSize dedicatedThreshold = 0;   // 0: half the block size
+    };
+
+    struct PoolReport {
+        uint32_t memoryType = 0;
+        uint32_t heap = 0;
+        bool optimal = false;       // Holds optimal-tiling images (only split out when granularity > 1)
+        uint32_t blocks = 0;
+        vk::DeviceSize reserved = 0;
+        vk::DeviceSize used = 0;
+        vk::DeviceSize largestFree = 0;
+        uint32_t allocations = 0;
+        uint32_t freeRanges = 0;
+        double fragmentation = 0.0; // 1 - largest free range / total free
+    };
+
+    struct Report {
+        std::vector<PoolReport> pools;
+        uint32_t dedicatedAllocations = 0;
+        vk::DeviceSize dedicatedBytes = 0;
+        uint32_t deviceAllocations = 0; // Live vkAllocateMemory objects
+        uint32_t maxDeviceAllocations = 0;
+        vk::DeviceSize reserved = 0;
+        vk::DeviceSize used = 0;
+    };
+
+    GpuAllocator() = default;
+    ~GpuAllocator();
+    GpuAllocator(const GpuAllocator&) = delete;
+    GpuAllocator& operator=(const GpuAllocator&) = delete;
+
+    void init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice, const Settings& settings);
+    void init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice) { init(device, physicalDevice, Settings{}); }
+
+    // Allocates and binds. Optimal-tiling images are assumed.
+    GpuAllocation bind(const vk::raii::Image& image, MemoryUsage usage);
+    GpuAllocation bind(const vk::raii::Buffer& buffer, MemoryUsage usage);
+
+    // Raw allocation for callers that bind themselves
+    GpuAllocation allocate(const vk::MemoryRequirements& requirements, MemoryUsage usage, bool optimal, bool dedicated = false);
+
+    // Needed on non-coherent memory only (no-ops otherwise): after CPU writes, before CPU reads
+    void flush(const GpuAllocation& allocation, vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE);
+    void invalidate(const GpuAllocation& allocation, vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE);
+
+    // Per-heap accounting, our own counts:
+    //  reserved: device memory held (blocks plus dedicated allocations)
+    //  used:     bytes handed out of it; goes down as soon as an allocation is released, even
+    //            when its block stays allocated
+    //  freed:    running total of bytes released, so callers can tell when a free has landed
+    struct HeapStats {
+        vk::DeviceSize reserved = 0;
+        vk::DeviceSize used = 0;
+        uint64_t freed = 0;
+    };
+    HeapStats heap_stats(uint32_t heap) const;
+    vk::DeviceSize heap_reserved(uint32_t heap) const { return heap_stats(heap).reserved; }
+    uint32_t heap_of(uint32_t memoryType) const { return m_memoryProperties.memoryTypes[memoryType].heapIndex; }
+    const vk::PhysicalDeviceMemoryProperties& memory_properties() const { return m_memoryProperties; }
+
+    Report report() const;
+    void print_report() const;
+
+private:
+    friend class GpuAllocation;
+
+    struct Block {
+        vk::raii::DeviceMemory memory{nullptr};
+        Tlsf tlsf;
+        std::byte* mapped = nullptr;
+        Block(vk::raii::DeviceMemory&& m, vk::DeviceSize size) : memory(std::move(m)), tlsf(size) {}
+    };
+    struct Pool {
+        uint32_t memoryType = 0;
+        bool optimal = false;
+        std::vector<std::unique_ptr<Block>> blocks;
+    };
+    struct Dedicated {
+        vk::raii::DeviceMemory memory{nullptr};
+        vk::DeviceSize size = 0;
+        uint32_t memoryType = 0;
+    };
+
+    GpuAllocation allocate_impl(const vk::MemoryRequirements& requirements, MemoryUsage usage, bool optimal,
+                                bool dedicated, const vk::MemoryDedicatedAllocateInfo* dedicatedInfo);
+    std::vector<uint32_t> candidate_types(uint32_t typeBits, MemoryUsage usage) const;
+    bool try_suballocate(Pool& pool, const vk::MemoryRequirements& requirements, GpuAllocation& out);
+    vk::raii::DeviceMemory allocate_memory(vk::DeviceSize size, uint32_t memoryType, const void* pNext);
+    Pool& pool_for(uint32_t memoryType, bool optimal);
+    void release(GpuAllocation& allocation);
+    vk::MappedMemoryRange mapped_range(const GpuAllocation& allocation, vk::DeviceSize offset, vk::DeviceSize size) const;
+    void publish_metrics();
+
+    const vk::raii::Device* m_device = nullptr;
+    vk::PhysicalDeviceMemoryProperties m_memoryProperties;
+    vk::DeviceSize m_granularity = 1;
+    vk::DeviceSize m_nonCoherentAtomSize = 1;
+    uint32_t m_maxAllocations = 0;
+    Settings m_settings;
+
+    mutable std::mutex m_mutex;
+    std::vector<Pool> m_pools;          // Indexed memoryType * 2 + optimal
+    std::list<Dedicated> m_dedicated;   // List: GpuAllocation keeps a pointer to its entry
+    uint32_t m_deviceAllocations = 0;
+    vk::DeviceSize m_reserved = 0;
+    std::vector<HeapStats> m_heaps;
+    vk::DeviceSize m_used = 0;
+
+    Gauge& m_reservedGauge = Metrics::get().gauge("gpu_memory_reserved_bytes");
+    Gauge& m_usedGauge = Metrics::get().gauge("gpu_memory_used_bytes");
+    Gauge& m_allocationsGauge = Metrics::get().gauge("gpu_memory_device_allocations");
+};
+
+} // namespace Zeta
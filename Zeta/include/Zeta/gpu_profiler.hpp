@@ -0,0 +1,92 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Zeta {
+
+struct GpuPassTiming {
+    const char* name;
+    uint64_t beginTicks;  // Raw (masked) GPU timestamp, used for trace export
+    double startMs;       // Relative to the first timestamp of the frame
+    double durationMs;
+};
+
+struct GpuFrameTiming {
+    uint64_t frame = 0;   // Timeline value the frame signalled
+    double totalMs = 0.0; // First begin to last end
+    std::vector<GpuPassTiming> passes;
+};
+
+// Timestamp-query profiler with one query pool per frame-in-flight slot.
+// A slot's results are only read once the frame timeline has passed the value that frame
+// signalled, so getResults never waits on the GPU.
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES = 32;
+    static constexpr size_t HISTORY_FRAMES = 240;
+
+    // RAII marker: writes a timestamp on construction and another on destruction.
+    // Names must outlive the profiler (string literals).
+    class Scope {
+    public:
+        Scope(GpuProfiler* profiler, const vk::raii::CommandBuffer& cmd, const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        GpuProfiler* m_profiler;
+        const vk::raii::CommandBuffer& m_cmd;
+        int32_t m_index = -1;
+    };
+
+    void init(const vk::raii::Device& device, float timestampPeriod, uint32_t timestampValidBits, uint32_t framesInFlight);
+
+    // Resolves every slot whose frame has completed, then resets this slot's pool inside cmd.
+    // Call right after cmd.begin() and after the slot's timeline wait.
+    void begin_frame(const vk::raii::CommandBuffer& cmd, uint32_t slot, uint64_t frameValue, uint64_t completedValue);
+
+    [[nodiscard]] Scope scope(const vk::raii::CommandBuffer& cmd, const char* name) { return Scope(this, cmd, name); }
+
+    bool enabled() const { return !m_slots.empty(); }
+
+    // Most recent fully resolved frame (empty until the first slot comes back)
+    const GpuFrameTiming& latest() const { return m_latest; }
+    // GPU milliseconds of the named pass in the latest resolved frame, 0 if absent
+    double pass_ms(std::string_view name) const;
+
+    // Writes the resolved history as Chrome-trace JSON (chrome://tracing, Perfetto)
+    bool write_chrome_trace(const std::string& path) const;
+
+private:
+    struct ScopeRecord {
+        const char* name;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+
+    struct Slot {
+        vk::raii::QueryPool pool{nullptr};
+        std::vector<ScopeRecord> scopes;
+        uint32_t queryCount = 0;
+        uint64_t frameValue = 0;
+        bool pending = false;
+    };
+
+    int32_t begin_scope(const vk::raii::CommandBuffer& cmd, const char* name);
+    void end_scope(const vk::raii::CommandBuffer& cmd, int32_t index);
+    void resolve(Slot& slot);
+
+    std::vector<Slot> m_slots;
+    Slot* m_current = nullptr;
+    double m_msPerTick = 0.0;
+    uint64_t m_tickMask = ~0ull;
+
+    GpuFrameTiming m_latest;
+    std::deque<GpuFrameTiming> m_history;
+};
+
+} // namespace Zeta
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Zeta {
+
+// Outstanding-job count for fork/join: run() increments it, completion decrements it,
+// Jobs::wait() returns once it reaches zero. The first exception thrown by one of its jobs is
+// kept and rethrown from wait().
+class JobCounter {
+public:
+    bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+    uint32_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+private:
+    friend class Jobs;
+    std::atomic<uint32_t> m_pending{0};
+    std::atomic<bool> m_failed{false};
+    std::exception_ptr m_error; // Written once by whoever sets m_failed, read after done()
+};
+
+// Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli 2013). The owner pushes and pops
+// at the bottom (LIFO, cache-warm); thieves take from the top (FIFO, oldest and usually largest).
+// Fixed capacity: push() fails when full and the caller runs the job inline instead.
+template<typename T, size_t Capacity = 4096>
+class WorkStealingDeque {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+    bool push(T* item) {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(Capacity)) return false;
+        m_items[b & MASK].store(item, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only
+    T* pop() {
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = m_items[b & MASK].load(std::memory_order_acquire);
+        if (t == b) {
+            // Last item: race the thieves for it
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) item = nullptr;
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread
+    T* steal() {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        T* item = m_items[t & MASK].load(std::memory_order_acquire);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+        return item;
+    }
+
+    bool empty() const {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int64_t MASK = static_cast<int64_t>(Capacity) - 1;
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    alignas(64) std::array<std::atomic<T*>, Capacity> m_items{};
+};
+
+// Work-stealing job scheduler: one worker per core, pinned, each with its own Chase-Lev deque.
+// The thread that calls init() gets deque 0 and is expected to help through wait(); jobs pushed
+// from any other non-worker thread go through a shared injection queue.
+class Jobs {
+public:
+    struct WorkerStats {
+        double utilization = 0.0; // Busy fraction since the previous stats() call
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+    };
+
+    static Jobs& get();
+
+    // workerCount 0: hardware_concurrency - 1 workers beside the calling thread
+    void init(uint32_t workerCount = 0, bool pinThreads = true);
+    void shutdown();
+    bool running() const { return !m_slots.empty(); }
+
+    // Total participants: workers plus the init() thread
+    uint32_t thread_count() const { return static_cast<uint32_t>(m_slots.size()); }
+    // 0 for the init() thread, 1..N for workers, -1 for anything else
+    static int32_t thread_index();
+
+    // A job that throws still completes; the exception goes to counter's wait(), or is logged
+    // when there is no counter
+    void run(std::function<void()> fn, JobCounter* counter = nullptr);
+    // Runs other jobs until counter reaches zero, never blocking while work exists. Rethrows the
+    // first exception of counter's jobs, after all of them finished.
+    void wait(JobCounter& counter);
+
+    // Calls fn(i) for i in [begin, end). Ranges are split in halves down to a grain sized from the
+    // range and the thread count (never below minGrain), so idle workers steal big halves first.
+    template<typename F>
+    void parallel_for(uint32_t begin, uint32_t end, F&& fn, uint32_t minGrain = 1) {
+        if (begin >= end) return;
+        uint32_t grain = std::max(minGrain, (end - begin) / (thread_count() * 8 + 1));
+        if (!running() || end - begin <= grain) {
+            for (uint32_t i = begin; i < end; ++i) fn(i);
+            return;
+        }
+        JobCounter counter;
+        std::exception_ptr error;
+        try {
+            split_range(begin, end, grain, fn, counter);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        wait(counter); // Queued halves reference counter and fn even when our own share threw
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Per-thread utilization since the last call; also published as job_* metrics
+    std::vector<WorkerStats> stats();
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        JobCounter* counter;
+    };
+
+    struct alignas(64) Slot {
+        WorkStealingDeque<Job> deque;
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        uint64_t lastBusyNs = 0;
+        uint64_t lastStolen = 0;
+    };
+
+    Jobs() = default;
+    ~Jobs();
+
+    template<typename F>
+    void split_range(uint32_t begin, uint32_t end, uint32_t grain, F& fn, JobCounter& counter) {
+        // Hand the upper half to the deque and keep halving the lower one here
+        while (end - begin > grain) {
+            uint32_t mid = begin + (end - begin) / 2;
+            run([this, mid, end, grain, &fn, &counter] { split_range(mid, end, grain, fn, counter); }, &counter);
+            end = mid;
+        }
+        for (uint32_t i = begin; i < end; ++i) fn(i);
+    }
+
+    void worker_loop(std::stop_token stop, uint32_t index);
+    Job* find_job(int32_t self);
+    void execute(Job* job, int32_t self);
+
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::vector<std::jthread> m_workers;
+
+    std::mutex m_injectMutex;
+    std::deque<Job*> m_inject;
+    std::atomic<uint32_t> m_injected{0}; // m_inject.size(), readable without the lock
+
+    // Sleepers wait for the epoch to move; run() bumps it
+    std::atomic<uint32_t> m_epoch{0};
+    std::atomic<uint32_t> m_sleeping{0};
+    uint64_t m_statsStartNs = 0;
+};
+
+} // namespace Zeta
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Zeta {
+
+// Monotonic event count
+class Counter {
+public:
+    void add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+// Last-written value
+class Gauge {
+public:
+    void set(double v) { m_bits.store(std::bit_cast<uint64_t>(v), std::memory_order_relaxed); }
+    double value() const { return std::bit_cast<double>(m_bits.load(std::memory_order_relaxed)); }
+private:
+    std::atomic<uint64_t> m_bits{0};
+};
+
+// HDR-style log-linear histogram over unsigned integers (pick the unit: us, ns, bytes...).
+// Values below SUB_COUNT are exact; above, every power of two is split into SUB_COUNT/2 linear
+// buckets, bounding the relative error of any quantile to ~1.6%. Recording is one relaxed add.
+class Histogram {
+public:
+    static constexpr uint32_t SUB_BITS = 7;
+    static constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr uint32_t MAX_BITS = 40; // Values are clamped to 2^40 - 1
+    static constexpr uint32_t BUCKET_COUNT = SUB_COUNT + (MAX_BITS - SUB_BITS + 1) * (SUB_COUNT / 2);
+
+    void record(uint64_t value);
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+    double mean() const;
+    // q in [0, 1], e.g. 0.5, 0.99, 0.999. Returns 0 when empty.
+    uint64_t quantile(double q) const;
+    void reset();
+
+private:
+    static uint32_t bucket_index(uint64_t value);
+    static uint64_t bucket_midpoint(uint32_t index);
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// Process-wide registry. Registration takes a lock and returns a reference that stays valid for
+// the life of the process, so hot paths look a metric up once and then only touch atomics.
+class Metrics {
+public:
+    static Metrics& get();
+
+    Counter& counter(std::string_view name);
+    Gauge& gauge(std::string_view name);
+    Histogram& histogram(std::string_view name);
+
+    // Text exposition (Prometheus-style, histograms as p50/p99/p99.9 summaries)
+    std::string snapshot() const;
+
+    // Serves snapshot() to every client that connects to a Unix domain socket, from a background
+    // thread. Default path: $XDG_RUNTIME_DIR/zeta-<pid>.sock (or /tmp). Try `socat - UNIX:<path>`.
+    bool serve(std::string path = {});
+    void stop();
+    const std::string& socket_path() const { return m_socketPath; }
+
+private:
+    Metrics() = default;
+    ~Metrics();
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<Counter>, std::less<>> m_counters;
+    std::map<std::string, std::unique_ptr<Gauge>, std::less<>> m_gauges;
+    std::map<std::string, std::unique_ptr<Histogram>, std::less<>> m_histograms;
+
+    std::jthread m_server;
+    std::string m_socketPath;
+    int m_listenFd = -1;
+};
+
+} // namespace Zeta
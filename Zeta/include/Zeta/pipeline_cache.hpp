@@ -0,0 +1,59 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Zeta {
+
+// VkPipelineCache persisted across runs at $XDG_CACHE_HOME/zeta/pipelines-<vendor>-<device>.bin
+// (falling back to ~/.cache). The file carries its own header so a blob from another GPU,
+// driver version or a truncated write is discarded instead of being handed to the driver.
+class PipelineCache {
+public:
+    // Creates the cache, seeded from disk when the file matches this device and driver
+    void init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice);
+
+    // Merges whatever another process saved since init(), then atomically replaces the file.
+    // Never throws: the Renderer destructor calls it.
+    bool save();
+
+    // Pass to vk::raii::Pipeline / createGraphicsPipelines
+    const vk::raii::PipelineCache& handle() const { return m_cache; }
+    // True when init() found a valid blob: pipeline creation should mostly hit the cache
+    bool warm() const { return m_loadedBytes > 0; }
+    size_t loaded_bytes() const { return m_loadedBytes; }
+    const std::filesystem::path& path() const { return m_path; }
+
+private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        std::array<uint8_t, VK_UUID_SIZE> pipelineCacheUUID;
+        uint32_t reserved; // Keeps the 64-bit fields aligned without implicit padding
+        uint64_t dataSize;
+        uint64_t dataHash;
+    };
+
+    static constexpr uint32_t MAGIC = 0x4843505a; // "ZPCH"
+    static constexpr uint32_t VERSION = 1;
+    // Driver blobs are a few MiB at most; anything claiming more is corrupt
+    static constexpr uint64_t MAX_DATA_SIZE = 256ull << 20;
+
+    static std::filesystem::path default_directory();
+    // Returns the driver blob if the file exists and its header matches m_header
+    std::vector<uint8_t> read_file() const;
+    bool write_file();
+
+    const vk::raii::Device* m_device = nullptr;
+    vk::raii::PipelineCache m_cache{nullptr};
+    FileHeader m_header{};
+    std::filesystem::path m_path;
+    size_t m_loadedBytes = 0;
+};
+
+} // namespace Zeta
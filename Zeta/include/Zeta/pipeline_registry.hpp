@@ -0,0 +1,130 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Zeta/metrics.hpp"
+
+namespace Zeta {
+
+// Everything that selects a graphics pipeline. Viewport and scissor are always dynamic and
+// rendering goes through dynamic rendering, so formats stand in for a render pass.
+struct GraphicsPipelineDesc {
+    std::string vertexShader;   // SPIR-V paths
+    std::string fragmentShader;
+    vk::PipelineLayout layout;
+
+    vk::Format colorFormat = vk::Format::eUndefined;
+    vk::Format depthFormat = vk::Format::eUndefined;
+
+    vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+    vk::PolygonMode polygonMode = vk::PolygonMode::eFill;
+    vk::CullModeFlags cullMode = vk::CullModeFlagBits::eBack;
+    vk::FrontFace frontFace = vk::FrontFace::eClockwise;
+
+    bool depthTest = false;
+    bool depthWrite = false;
+    vk::CompareOp depthCompare = vk::CompareOp::eLessOrEqual;
+
+    bool blendEnable = false;
+    vk::BlendFactor srcColorFactor = vk::BlendFactor::eOne;
+    vk::BlendFactor dstColorFactor = vk::BlendFactor::eZero;
+    vk::BlendOp colorBlendOp = vk::BlendOp::eAdd;
+    vk::BlendFactor srcAlphaFactor = vk::BlendFactor::eOne;
+    vk::BlendFactor dstAlphaFactor = vk::BlendFactor::eZero;
+    vk::BlendOp alphaBlendOp = vk::BlendOp::eAdd;
+    vk::ColorComponentFlags colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                             vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+
+    bool operator==(const GraphicsPipelineDesc&) const = default;
+
+    uint64_t hash() const;
+    // Keys of the four VK_EXT_graphics_pipeline_library parts this desc links from
+    uint64_t vertex_input_hash() const;
+    uint64_t pre_raster_hash() const;
+    uint64_t fragment_shader_hash() const;
+    uint64_t fragment_output_hash() const;
+};
+
+enum class PipelineStatus : uint8_t { Pending, Ready, Failed };
+
+// Deduplicating, asynchronous pipeline compiler. request() never blocks on the driver: it returns
+// a handle at once and worker threads compile behind it. With VK_EXT_graphics_pipeline_library the
+// four stage libraries are compiled (and shared) independently, so a new permutation of known
+// shaders and states is only a fast link.
+class PipelineRegistry {
+    struct Entry {
+        GraphicsPipelineDesc desc;
+        uint64_t hash = 0;
+        std::atomic<PipelineStatus> status{PipelineStatus::Pending};
+        vk::raii::Pipeline pipeline{nullptr};
+    };
+
+public:
+    // Cheap to copy; stays valid for the life of the registry
+    class Handle {
+    public:
+        Handle() = default;
+        bool valid() const { return m_entry != nullptr; }
+        PipelineStatus status() const { return m_entry ? m_entry->status.load(std::memory_order_acquire) : PipelineStatus::Failed; }
+        bool ready() const { return status() == PipelineStatus::Ready; }
+        // Null until the worker has finished: skip the draw rather than wait
+        vk::Pipeline pipeline() const { return ready() ? *m_entry->pipeline : vk::Pipeline{}; }
+    private:
+        friend class PipelineRegistry;
+        explicit Handle(Entry* entry) : m_entry(entry) {}
+        Entry* m_entry = nullptr;
+    };
+
+    ~PipelineRegistry();
+
+    // workerCount 0 picks from hardware_concurrency
+    void init(const vk::raii::Device& device, const vk::raii::PipelineCache& cache, bool useLibraries, uint32_t workerCount = 0);
+    // Joins the workers; pending requests are marked Failed
+    void shutdown();
+
+    Handle request(const GraphicsPipelineDesc& desc);
+    // Blocks until the pipeline is built or has failed. For startup-critical pipelines only.
+    vk::Pipeline wait(Handle handle);
+
+    bool uses_libraries() const { return m_useLibraries; }
+    size_t size() const;
+    size_t pending() const;
+
+private:
+    void worker_loop(std::stop_token stop);
+    void compile(Entry& entry);
+    vk::raii::Pipeline build_monolithic(const GraphicsPipelineDesc& desc);
+    vk::raii::Pipeline build_linked(const GraphicsPipelineDesc& desc);
+    vk::Pipeline get_library(vk::GraphicsPipelineLibraryFlagBitsEXT part, uint64_t key, const GraphicsPipelineDesc& desc);
+
+    const vk::raii::Device* m_device = nullptr;
+    const vk::raii::PipelineCache* m_cache = nullptr;
+    bool m_useLibraries = false;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_workDone;
+    std::deque<Entry> m_entries;                     // Never erased, so Handle pointers stay valid
+    std::unordered_multimap<uint64_t, Entry*> m_lookup;
+    std::deque<Entry*> m_queue;
+
+    // GPL parts keyed by part hash. Built outside the lock; a racing duplicate is discarded.
+    std::mutex m_libraryMutex;
+    std::unordered_map<uint64_t, vk::raii::Pipeline> m_libraries;
+
+    std::vector<std::jthread> m_workers;
+
+    Counter& m_requests = Metrics::get().counter("pipeline_requests");
+    Counter& m_dedupHits = Metrics::get().counter("pipeline_dedup_hits");
+    Counter& m_failures = Metrics::get().counter("pipeline_failures");
+    Histogram& m_compileTime = Metrics::get().histogram("pipeline_compile_us");
+};
+
+} // namespace Zeta
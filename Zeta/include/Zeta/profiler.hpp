@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Zones are recorded in debug builds only; define ZETA_FORCE_PROFILE to keep them in release.
+// When disabled the macros expand to nothing, so instrumented code pays zero cost.
+#if !defined(NDEBUG) || defined(ZETA_FORCE_PROFILE)
+#define ZETA_PROFILE_ENABLED 1
+#endif
+
+namespace Zeta {
+
+struct ZoneRecord {
+    const char* name; // Must outlive the profiler (string literal)
+    uint64_t startNs;
+    uint64_t endNs;
+    uint32_t thread;
+};
+
+// CPU zone profiler. Each thread writes finished zones into its own single-producer ring
+// (no locks, no allocation on the hot path); flush() drains every ring into the collector
+// once per frame and write_chrome_trace() exports the collected zones.
+class Profiler {
+public:
+    static constexpr size_t THREAD_BUFFER_SIZE = 16384;  // Zones per thread between flushes
+    static constexpr size_t MAX_COLLECTED = 1u << 20;     // Oldest half is discarded past this
+
+    static Profiler& get();
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Hot path, called from any thread
+    void record(const char* name, uint64_t startNs, uint64_t endNs);
+    // Names the calling thread in exported traces
+    void set_thread_name(const char* name);
+
+    // Moves every thread's pending zones into the collector. Call once per frame.
+    void flush();
+    // Writes everything collected so far as Chrome-trace/Perfetto JSON
+    bool write_chrome_trace(const std::string& path);
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct ThreadBuffer {
+        std::vector<ZoneRecord> ring = std::vector<ZoneRecord>(THREAD_BUFFER_SIZE);
+        std::atomic<size_t> head{0}; // Written by the owning thread
+        std::atomic<size_t> tail{0}; // Written by flush()
+        uint32_t id = 0;
+        std::string name;
+    };
+
+    Profiler() = default;
+    ThreadBuffer& thread_buffer();
+
+    std::mutex m_mutex; // Guards registration and the collected zones, never the hot path
+    std::vector<std::shared_ptr<ThreadBuffer>> m_threads;
+    std::vector<ZoneRecord> m_collected;
+    std::atomic<uint64_t> m_dropped{0};
+};
+
+class ScopedZone {
+public:
+    explicit ScopedZone(const char* name) : m_name(name), m_start(Profiler::now_ns()) {}
+    ~ScopedZone() { Profiler::get().record(m_name, m_start, Profiler::now_ns()); }
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+private:
+    const char* m_name;
+    uint64_t m_start;
+};
+
+} // namespace Zeta
+
+#ifdef ZETA_PROFILE_ENABLED
+#define ZETA_ZONE_CONCAT_INNER(a, b) a##b
+#define ZETA_ZONE_CONCAT(a, b) ZETA_ZONE_CONCAT_INNER(a, b)
+#define ZETA_ZONE(name) ::Zeta::ScopedZone ZETA_ZONE_CONCAT(zetaZone_, __LINE__)(name)
+#define ZETA_PROFILER_FLUSH() ::Zeta::Profiler::get().flush()
+#define ZETA_THREAD_NAME(name) ::Zeta::Profiler::get().set_thread_name(name)
+#else
+#define ZETA_ZONE(name) ((void)0)
+#define ZETA_PROFILER_FLUSH() ((void)0)
+#define ZETA_THREAD_NAME(name) ((void)0)
+#endif
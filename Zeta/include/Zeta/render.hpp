@@ -1,16 +1,106 @@
 #pragma once
 #include <vulkan/vulkan_raii.hpp>
+#include <chrono>
 #include <optional>
+#include <string>
 #include <vector>
+#include "Zeta/asset_streamer.hpp"
+#include "Zeta/command_recorder.hpp"
+#include "Zeta/deletion_queue.hpp"
+#include "Zeta/dynamic_resolution.hpp"
+#include "Zeta/gpu_allocator.hpp"
+#include "Zeta/gpu_profiler.hpp"
+#include "Zeta/metrics.hpp"
+#include "Zeta/pipeline_cache.hpp"
+#include "Zeta/pipeline_registry.hpp"
+#include "Zeta/residency.hpp"
+#include "Zeta/swapchain_policy.hpp"
+#include "Zeta/task.hpp"
+#include "Zeta/transfer_queue.hpp"
+#include "Zeta/upload_ring.hpp"
 
 namespace Zeta {
+    std::vector<uint32_t> load_spirv(const std::string& filename);
+
+    // Set 0, binding 0 of every pipeline the renderer builds (dynamic uniform buffer, std140)
+    struct FrameUniforms {
+        float time = 0.0f;        // Seconds since init
+        uint32_t frame = 0;       // Timeline value this frame signals
+        float renderScale = 1.0f;
+        float pad = 0.0f;
+        float extent[2] = {};     // Render area in pixels
+        float invExtent[2] = {};
+    };
+
     class Renderer {
     public:
     Renderer();
+    ~Renderer();
         void init(wl_display* display, wl_surface* surface, uint32_t width, uint32_t height);
-        void draw_frame();
+        // No compositor needed: renders into offscreen images (works on lavapipe/llvmpipe)
+        void init_headless(uint32_t width, uint32_t height);
+        // True when the frame reached the compositor (false: headless, or the swapchain went out of date)
+        bool draw_frame();
+        // Must be called before init()/init_headless(), clamped to [1, MAX_FRAMES_IN_FLIGHT]
+        void set_frames_in_flight(uint32_t count);
+        uint32_t frames_in_flight() const { return m_framesInFlight; }
+        static constexpr uint32_t max_frames_in_flight() { return MAX_FRAMES_IN_FLIGHT; }
+        // Must be called before init()/init_headless(). 0 records on the calling thread only;
+        // N > 0 records the main pass as secondaries across N threads (the caller included).
+        void set_recording_threads(uint32_t count);
+        // Must be called before init()/init_headless(): bytes of per-frame upload space for each
+        // frame-in-flight slot (uniforms, push-data overflow, dynamic vertices)
+        void set_upload_ring_size(vk::DeviceSize bytes);
+        // Synthetic load: the main pass issues this many draws (benchmarks, stress tests)
+        void set_draw_count(uint32_t count) { m_drawCount = count; }
+        // CPU time spent recording the last frame's command buffers
+        float last_record_ms() const { return m_lastRecordMs; }
+        // Dynamic resolution: the main pass renders into a swapchain-sized scene target at a scale the
+        // controller picks from GPU timestamps to hold targetMs, then a linear blit fills the
+        // swapchain image. The target is allocated once; only the render area moves. 0 disables.
+        void set_dynamic_resolution(double targetMs, float minScale = 0.5f, float maxScale = 1.0f);
+        bool dynamic_resolution() const { return static_cast<bool>(*m_sceneImage); }
+        float render_scale() const { return m_drs.scale(); }
+        vk::Extent2D render_extent() const { return m_renderExtent; }
+        // Present mode, image count and format are picked per profile from what the surface reports.
+        // Callable any time (default LowLatency); the swapchain is rebuilt at the next draw_frame().
+        void set_swapchain_profile(SwapchainProfile profile);
+        SwapchainProfile swapchain_profile() const { return m_swapchainProfile; }
+        vk::PresentModeKHR present_mode() const { return m_presentMode; }
         void recreate_swapchain(uint32_t width, uint32_t height);
         void handle_resize(uint32_t width, uint32_t height);
+
+        bool is_headless() const { return m_headless; }
+        vk::Extent2D extent() const { return m_swapchainExtent; }
+        vk::Format format() const { return m_swapchainFormat; }
+        uint64_t frame_count() const { return m_currentFrameCounter; }
+
+        // Headless only: copy the next frame's final image to host memory.
+        // take_readback() waits for that frame and returns tightly packed RGBA8 rows.
+        void request_readback();
+        std::vector<uint8_t> take_readback();
+        // Same, without the stall: completes (on the main queue) once the GPU has passed that frame
+        Task<std::vector<uint8_t>> readback_async();
+
+        // Signalled with frame N's number when frame N finishes on the GPU; pair with
+        // TaskScheduler::wait_timeline() to chain work on frames without blocking
+        const vk::raii::Semaphore& frame_timeline() const { return m_frameTimeline; }
+
+        // Per-pass GPU timings, resolved a few frames behind without stalling
+        const GpuProfiler& gpu_profiler() const { return m_gpuProfiler; }
+
+        // Device memory for every image and buffer the renderer owns
+        GpuAllocator& allocator() { return m_allocator; }
+        const UploadRing& upload_ring() const { return m_uploadRing; }
+        // Per-heap budget tracking; streamable resources register here to be evicted under pressure
+        ResidencyManager& residency() { return m_residency; }
+        // Streaming uploads on a dedicated transfer queue (the graphics queue when there is none)
+        TransferQueue& transfer() { return m_transfer; }
+        // File reads into the transfer queue's staging ring; completions run in draw_frame()
+        AssetStreamer& streamer() { return m_streamer; }
+        // Async compute family and queue, UINT32_MAX and null when the device has none
+        uint32_t compute_family() const { return m_computeFamily; }
+        const vk::raii::Queue& compute_queue() const { return m_computeQueue; }
     private:
         // Config
         //const int MAX_FRAMES_IN_FLIGHT = 2;
@@ -21,12 +111,24 @@ namespace Zeta {
         vk::raii::SurfaceKHR m_surface;
         vk::raii::PhysicalDevice m_physicalDevice;
         vk::raii::Device m_device;
+        // Right after the device: destroyed after everything holding a GpuAllocation
+        GpuAllocator m_allocator;
+        ResidencyManager m_residency;
+        bool m_memoryBudget = false; // VK_EXT_memory_budget enabled
         vk::raii::Queue m_graphicsQueue;
+        vk::raii::Queue m_transferQueue{nullptr}; // Null when uploads share the graphics queue
+        vk::raii::Queue m_computeQueue{nullptr};
+        uint32_t m_transferFamily = 0;
+        uint32_t m_computeFamily = UINT32_MAX;
+        TransferQueue m_transfer;
+        AssetStreamer m_streamer; // After m_transfer: its reads land in the staging ring
+        vk::DeviceSize m_stagingSize = 64ull << 20;
         vk::raii::SwapchainKHR m_swapchain;
         vk::raii::CommandPool m_commandPool;
         vk::raii::CommandBuffers m_commandBuffers; // RAII vectors handle their own lifetime
         // Sync Objects
-        static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+        uint32_t m_framesInFlight = 2;
 
         // Binary semaphores (one per frame-in-flight slot)
         std::vector<vk::raii::Semaphore> m_imageAvailableSemaphores;
@@ -40,19 +142,60 @@ namespace Zeta {
         vk::Extent2D m_swapchainExtent;
         vk::Format m_swapchainFormat;
         std::vector<vk::raii::ImageView> m_swapchainImageViews;
+        SwapchainProfile m_swapchainProfile = SwapchainProfile::LowLatency;
+        vk::PresentModeKHR m_presentMode = vk::PresentModeKHR::eFifo;
+        std::optional<SwapchainProfile> m_loggedProfile; // Profile of the last logged swapchain, none before the first
 
         vk::raii::DebugUtilsMessengerEXT m_debugMessenger{nullptr};
+        bool m_debugUtils = false;
+
+        // Headless mode: offscreen targets stand in for the swapchain images
+        bool m_headless = false;
+        std::vector<vk::raii::Image> m_offscreenImages;
+        std::vector<GpuAllocation> m_offscreenMemory;
+        vk::raii::Buffer m_readbackBuffer{nullptr};
+        GpuAllocation m_readbackMemory;
+        bool m_readbackRequested = false;
+        uint64_t m_readbackValue = 0; // Timeline value of the frame holding the pending readback
         // Command Pool and Buffers
 
 
         wl_display* m_display;
 
 
-        std::optional<vk::raii::QueryPool> m_query_pool;
-        std::vector<uint64_t> m_query_results;
-        float m_timestamp_period; // Period in nanoseconds per tick
+        GpuProfiler m_gpuProfiler;
+
+        // Multi-threaded main pass recording (disabled when m_recordingThreads == 0)
+        ParallelRecorder m_recorder;
+        uint32_t m_recordingThreads = 0;
+        uint32_t m_drawCount = 1;
+        float m_lastRecordMs = 0.0f;
+        Histogram& m_recordTime = Metrics::get().histogram("record_us");
+        void record_draws(const vk::raii::CommandBuffer& cmd, uint32_t first, uint32_t count);
+
+        // Telemetry (Zeta::Metrics), looked up once
+        Counter& m_swapchainRecreations = Metrics::get().counter("swapchain_recreations");
+        Histogram& m_swapchainRecreateTime = Metrics::get().histogram("swapchain_recreate_us");
+        Gauge& m_retiredObjects = Metrics::get().gauge("deletion_queue_objects");
+        Histogram& m_acquireLatency = Metrics::get().histogram("acquire_latency_us");
+        Histogram& m_presentLatency = Metrics::get().histogram("present_latency_us");
+        Gauge& m_swapchainProfileGauge = Metrics::get().gauge("swapchain_profile");
+        Gauge& m_swapchainPresentModeGauge = Metrics::get().gauge("swapchain_present_mode"); // VkPresentModeKHR value
+        Gauge& m_swapchainImagesGauge = Metrics::get().gauge("swapchain_images");
+        Counter& m_swapchainFallbacks = Metrics::get().counter("swapchain_policy_fallbacks");
+        float m_timestamp_period = 0.0f; // Period in nanoseconds per tick
 
 
+        // Dynamic resolution scene target (null while disabled or unsupported)
+        DynamicResolution m_drs;
+        vk::raii::Image m_sceneImage{nullptr};
+        GpuAllocation m_sceneMemory;
+        vk::raii::ImageView m_sceneView{nullptr};
+        vk::Extent2D m_renderExtent{};
+        void create_scene_target();
+        void retire_scene_target(uint64_t retireValue);
+        void update_render_scale();
+
         bool m_resizeRequested = false;
         uint32_t m_newWidth = 0;
         uint32_t m_newHeight = 0;
@@ -66,20 +209,48 @@ namespace Zeta {
         vk::raii::SurfaceKHR create_surface(wl_display* display, wl_surface* surface);
         vk::raii::PhysicalDevice create_physical_device();
         uint32_t find_queue_family();
+        void find_async_families();
         vk::raii::Device create_logical_device();
         vk::raii::Queue create_graphics_queue();
+        void create_transfer_queue();
         vk::raii::SwapchainKHR create_swapchain(uint32_t width, uint32_t height, VkSwapchainKHR oldHandle);
         vk::raii::CommandPool create_command_pool();
         vk::raii::CommandBuffers create_command_buffers();
+        void create_swapchain_image_views();
+        void create_offscreen_targets(uint32_t width, uint32_t height);
 
-        uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties);
         uint32_t m_queueFamilyIndex = 0;
 
         void create_sync_objects();
-        void refresh_sync_objects();
+        void refresh_sync_objects(uint64_t retireValue);
+
+        // Persistent driver cache, saved on shutdown so the next launch starts warm
+        PipelineCache m_pipelineCache;
+        Gauge& m_pipelineCreateMs = Metrics::get().gauge("pipeline_create_ms");
+        // Per-frame data: FrameUniforms and anything else recorded this frame lives in the ring;
+        // the one descriptor set is rebound with a dynamic offset instead of being rewritten
+        UploadRing m_uploadRing;
+        vk::DeviceSize m_uploadRingSize = 1 << 20;
+        vk::raii::DescriptorSetLayout m_frameSetLayout{nullptr};
+        vk::raii::DescriptorPool m_descriptorPool{nullptr};
+        vk::raii::DescriptorSet m_frameSet{nullptr};
+        uint32_t m_frameUniformOffset = 0;
+        std::chrono::steady_clock::time_point m_startTime;
+        void create_frame_resources();
+        void write_frame_uniforms();
 
         vk::raii::PipelineLayout m_pipelineLayout{nullptr};
-        vk::raii::Pipeline m_graphicsPipeline{nullptr};
+        // Compiles on worker threads through m_pipelineCache; declared after it so it stops first
+        PipelineRegistry m_pipelines;
+        PipelineRegistry::Handle m_trianglePipeline;
+        bool m_graphicsPipelineLibrary = false;
+        GraphicsPipelineDesc triangle_pipeline_desc() const;
         void create_graphics_pipeline();
+        void record_commands(const vk::raii::CommandBuffer& cmd, uint32_t imageIndex);
+        void record_readback(const vk::raii::CommandBuffer& cmd, uint32_t imageIndex);
+
+        // Retired swapchains, views and semaphores waiting for m_frameTimeline to pass them.
+        // Declared last so it is destroyed before the device.
+        DeletionQueue m_deletionQueue;
     };
 }
\ No newline at end of file
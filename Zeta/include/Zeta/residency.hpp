@@ -0,0 +1,103 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Zeta/gpu_allocator.hpp"
+#include "Zeta/metrics.hpp"
+
+namespace Zeta {
+
+// Keeps device memory use under the driver's budget. Once per frame it reads each heap's budget
+// (VK_EXT_memory_budget, or 80% of the heap when the extension is missing) and measures usage as
+// the bytes our allocator has handed out plus whatever the driver reports beyond our blocks. For
+// heaps past evictAbove it evicts the least recently used streamable resources until the heap is
+// projected back under evictTo. Resources used within minIdleFrames are never evicted, so a frame
+// never loses something it just drew with.
+class ResidencyManager {
+public:
+    using ResourceId = uint64_t; // 0 is never a valid id
+
+    struct Settings {
+        double evictAbove = 0.90;
+        double evictTo = 0.80;
+        uint32_t minIdleFrames = 60;
+    };
+
+    struct HeapStatus {
+        vk::DeviceSize budget = 0;
+        vk::DeviceSize usage = 0;
+        bool deviceLocal = false;
+    };
+
+    void init(const vk::raii::PhysicalDevice& physicalDevice, const GpuAllocator& allocator, bool memoryBudget,
+              const Settings& settings);
+    void init(const vk::raii::PhysicalDevice& physicalDevice, const GpuAllocator& allocator, bool memoryBudget) {
+        init(physicalDevice, allocator, memoryBudget, Settings{});
+    }
+    bool has_memory_budget() const { return m_memoryBudget; }
+
+    // Registers memory the owner can drop and stream back later. evict() must release it back to
+    // the GpuAllocator, normally by retiring it through the deletion queue; it runs on the thread
+    // calling update(). Its bytes count as gone from the moment of eviction.
+    ResourceId add(uint32_t heap, vk::DeviceSize size, std::function<void()> evict);
+    ResourceId add(const GpuAllocation& allocation, std::function<void()> evict);
+    // Marks the resource as used by the current frame
+    void touch(ResourceId id);
+    // The owner released it itself; evict() is not called
+    void remove(ResourceId id);
+    bool resident(ResourceId id) const;
+
+    // Call once per frame, after the deletion queue has freed what it can
+    void update(uint64_t frame);
+
+    std::vector<HeapStatus> heaps() const;
+    uint64_t frame() const { return m_frame; }
+
+private:
+    struct Resource {
+        ResourceId id;
+        vk::DeviceSize size;
+        uint64_t lastUsed;
+        std::function<void()> evict;
+    };
+    // Evicted bytes not yet released to the allocator (the deletion queue holds them for a few frames)
+    struct Pending {
+        uint32_t heap;
+        vk::DeviceSize size;
+        uint64_t freedTarget; // Heap's running freed total at which this eviction has landed
+    };
+    struct Heap {
+        HeapStatus status;
+        GpuAllocator::HeapStats stats;
+        uint64_t freedTarget = 0; // Of the newest pending eviction
+        vk::DeviceSize size = 0;
+        std::list<Resource> lru; // Most recently used first
+        bool overBudget = false; // Reported once per episode
+        Gauge* usageGauge = nullptr;
+        Gauge* budgetGauge = nullptr;
+    };
+
+    void refresh_budgets();
+
+    const vk::raii::PhysicalDevice* m_physicalDevice = nullptr;
+    const GpuAllocator* m_allocator = nullptr;
+    bool m_memoryBudget = false;
+    Settings m_settings;
+
+    mutable std::mutex m_mutex;
+    std::vector<Heap> m_heaps;
+    std::unordered_map<ResourceId, std::pair<uint32_t, std::list<Resource>::iterator>> m_lookup;
+    std::vector<Pending> m_pending;
+    ResourceId m_nextId = 1;
+    uint64_t m_frame = 0;
+
+    Counter& m_evictions = Metrics::get().counter("residency_evictions");
+    Counter& m_evictedBytes = Metrics::get().counter("residency_evicted_bytes");
+    Gauge& m_resources = Metrics::get().gauge("residency_resources");
+};
+
+} // namespace Zeta
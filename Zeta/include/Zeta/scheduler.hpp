@@ -0,0 +1,174 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Zeta/task.hpp"
+
+namespace Zeta {
+
+// Where a suspended coroutine continues
+enum class ResumeOn : uint8_t {
+    Main,   // Next run_main_queue() call, i.e. the frame loop
+    Worker  // A Zeta::Jobs worker (falls back to Main when the pool is not running)
+};
+
+// Resumes coroutines when what they wait on is ready, so no thread blocks for them:
+//  - GPU timeline values, checked by one watcher thread polling the semaphore counter
+//  - Blocking I/O, run on a dedicated I/O thread
+//  - Plain hops onto the main queue or the job pool
+class TaskScheduler {
+public:
+    static constexpr auto WATCH_INTERVAL = std::chrono::microseconds(250);
+
+    static TaskScheduler& get();
+
+    // Starts a top-level task; its frame frees itself when it finishes
+    void spawn(Task<void> task);
+    // Runs the task to completion, pumping the main queue meanwhile (tools, tests, shutdown)
+    template<typename T>
+    T run_until_complete(Task<T> task);
+
+    // Resumes everything queued for ResumeOn::Main. Call once per frame on the main thread.
+    size_t run_main_queue();
+
+    // co_await schedule(ResumeOn::Worker) moves the rest of the coroutine onto the job pool
+    auto schedule(ResumeOn where) {
+        struct Awaiter {
+            TaskScheduler* scheduler;
+            ResumeOn where;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler->resume(handle, where); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ this, where };
+    }
+
+    // co_await wait_timeline(sem, v) continues once sem's counter reaches v. The semaphore must
+    // outlive the wait. Already-signalled values do not suspend at all.
+    auto wait_timeline(const vk::raii::Semaphore& semaphore, uint64_t value, ResumeOn where = ResumeOn::Main) {
+        struct Awaiter {
+            TaskScheduler* scheduler;
+            const vk::raii::Semaphore* semaphore;
+            uint64_t value;
+            ResumeOn where;
+            bool await_ready() const { return semaphore->getCounterValue() >= value; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler->watch(*semaphore, value, handle, where); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ this, &semaphore, value, where };
+    }
+
+    // co_await offload(fn) runs fn on the I/O thread (it may block), then continues at `where`.
+    // Exceptions thrown by fn propagate to the awaiting coroutine.
+    auto offload(std::function<void()> fn, ResumeOn where = ResumeOn::Main) {
+        struct Awaiter {
+            TaskScheduler* scheduler;
+            std::function<void()> fn;
+            ResumeOn where;
+            std::exception_ptr error;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                scheduler->post_io([this, handle] {
+                    try { fn(); } catch (...) { error = std::current_exception(); }
+                    scheduler->resume(handle, where);
+                });
+            }
+            void await_resume() const { if (error) std::rethrow_exception(error); }
+        };
+        return Awaiter{ this, std::move(fn), where, nullptr };
+    }
+
+    // Whole-file read off the calling thread
+    Task<std::vector<uint8_t>> read_file(std::string path, ResumeOn where = ResumeOn::Main);
+
+    // Stops the watcher and I/O threads. Coroutines still waiting are dropped (never resumed).
+    void shutdown();
+
+    size_t watched() const;
+    uint32_t in_flight() const { return m_inFlight.load(std::memory_order_relaxed); }
+
+private:
+    struct Watch {
+        const vk::raii::Semaphore* semaphore;
+        uint64_t value;
+        std::coroutine_handle<> handle;
+        ResumeOn where;
+    };
+
+    TaskScheduler() = default;
+    ~TaskScheduler();
+
+    void resume(std::coroutine_handle<> handle, ResumeOn where);
+    void watch(const vk::raii::Semaphore& semaphore, uint64_t value, std::coroutine_handle<> handle, ResumeOn where);
+    void post_io(std::function<void()> fn);
+    void watcher_loop(std::stop_token stop);
+    void io_loop(std::stop_token stop);
+
+    std::mutex m_mainMutex;
+    std::deque<std::coroutine_handle<>> m_mainQueue;
+
+    mutable std::mutex m_watchMutex;
+    std::condition_variable_any m_watchCv;
+    std::vector<Watch> m_watches;
+    std::jthread m_watcher;
+
+    std::mutex m_ioMutex;
+    std::condition_variable_any m_ioCv;
+    std::deque<std::function<void()>> m_ioQueue;
+    std::jthread m_ioThread;
+
+    std::atomic<uint32_t> m_inFlight{0}; // Spawned tasks not yet finished
+};
+
+namespace detail {
+
+// Fire-and-forget coroutine frame: starts immediately and destroys itself at the end
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+}
+
+template<typename T>
+T TaskScheduler::run_until_complete(Task<T> task) {
+    std::atomic<bool> finished{false};
+    std::exception_ptr error;
+    std::optional<std::conditional_t<std::is_void_v<T>, int, T>> result;
+
+    auto runner = [&](Task<T> inner) -> detail::DetachedTask {
+        try {
+            if constexpr (std::is_void_v<T>) co_await inner;
+            else result.emplace(co_await inner);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        finished.store(true, std::memory_order_release);
+    };
+    runner(std::move(task));
+
+    while (!finished.load(std::memory_order_acquire)) {
+        if (run_main_queue() == 0) std::this_thread::sleep_for(WATCH_INTERVAL);
+    }
+    if (error) std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>) return std::move(*result);
+}
+
+} // namespace Zeta
@@ -0,0 +1,36 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace Zeta {
+
+// What the swapchain is tuned for. Each profile is an ordered wish list; choose_swapchain()
+// takes the first entry the surface actually reports, and FIFO (the only mode the spec
+// guarantees) always terminates the present-mode list.
+enum class SwapchainProfile : uint8_t {
+    LowLatency, // MAILBOX > IMMEDIATE > FIFO, one image beyond the minimum so mailbox never blocks
+    Throughput, // FIFO_RELAXED > FIFO, two extra images so the GPU never waits on the display
+    PowerSaver  // FIFO at the minimum image count, 8-bit formats first
+};
+
+const char* profile_name(SwapchainProfile profile);
+// Accepts the names profile_name() returns ("low-latency", "throughput", "power-saver")
+std::optional<SwapchainProfile> parse_swapchain_profile(std::string_view name);
+
+struct SwapchainChoice {
+    vk::PresentModeKHR presentMode = vk::PresentModeKHR::eFifo;
+    uint32_t imageCount = 0;
+    vk::SurfaceFormatKHR format;
+    vk::CompositeAlphaFlagBitsKHR compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
+    bool fallback = false; // Something other than the profile's first choice was used
+};
+
+SwapchainChoice choose_swapchain(SwapchainProfile profile,
+                                 const vk::SurfaceCapabilitiesKHR& capabilities,
+                                 std::span<const vk::PresentModeKHR> presentModes,
+                                 std::span<const vk::SurfaceFormatKHR> formats);
+
+} // namespace Zeta
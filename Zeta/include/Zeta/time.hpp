@@ -2,6 +2,53 @@
 #include <chrono>
 #include <thread>
 
+namespace Zeta { class Histogram; }
+
+// Sleeps to absolute, drift-free frame deadlines: a coarse OS sleep that stops short of the
+// deadline by a margin calibrated from measured wake-up overshoot, then a short spin.
+class FramePacer {
+public:
+	using clock = std::chrono::steady_clock;
+
+	enum class SleepMode {
+		SleepUntil,     // std::this_thread::sleep_until
+		ClockNanosleep, // clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME)
+		TimerFd         // timerfd armed with an absolute CLOCK_MONOTONIC deadline
+	};
+
+	FramePacer() = default;
+	~FramePacer();
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	void setMode(SleepMode mode);
+	SleepMode getMode() const { return m_mode; }
+
+	// Waits for the next deadline of a `limit` Hz schedule (limit <= 0 disables pacing).
+	// Deadlines accumulate (deadline += period) so error never compounds across frames;
+	// the schedule only resyncs after a limit change or a frame that ran a full period late.
+	void wait(int limit);
+
+	// Current margin the pacer spins for instead of trusting the OS sleep
+	float getSpinMarginUs() const { return m_spinMarginUs; }
+	// Mean OS wake-up overshoot measured so far
+	float getOvershootUs() const { return m_overshootMeanUs; }
+
+private:
+	void sleep_until(clock::time_point target);
+	void calibrate(float overshootUs);
+
+	SleepMode m_mode = SleepMode::ClockNanosleep;
+	int m_timerFd = -1;
+	int m_lastLimit = 0;
+	clock::time_point m_deadline{};
+
+	// Running overshoot statistics (EWMA of mean and absolute deviation)
+	float m_overshootMeanUs = 100.0f;
+	float m_overshootDevUs = 50.0f;
+	float m_spinMarginUs = 250.0f;
+};
+
 class Fps {
 private:
 
@@ -10,6 +57,13 @@ private:
 	float m_frameTime = 0;
 	float m_fps = 0.0f;
 	float m_delay = 0.0f;
+	float m_workTime = 0;
+
+	FramePacer m_pacer;
+
+	// Registered as frame_time_us / frame_work_us in Zeta::Metrics
+	Zeta::Histogram* m_frameHistogram = nullptr;
+	Zeta::Histogram* m_workHistogram = nullptr;
 
 public:
 	Fps();
@@ -18,7 +72,13 @@ public:
 	void begin();
 	void end();
 
+	// Frames per second actually achieved, measured begin-to-begin (includes pacing)
 	float getFps();
+	// Milliseconds between begin() and end(), i.e. the real cost of the frame
+	float getWorkMs() const { return m_workTime; }
+	// Milliseconds of the last paced frame, begin-to-begin
+	float getFrameMs() const { return m_frameTime; }
+	FramePacer& pacer() { return m_pacer; }
 
 	int m_limit = 250;
 };
@@ -31,5 +91,7 @@ private:
 public:
 	void begin();
 	void end();
-	float getFps();
+	// Microseconds between begin() and end()
+	float getElapsedUs() const { return m_frameTime; }
+	[[deprecated("returns microseconds, use getElapsedUs()")]] float getFps();
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Zeta {
+
+// Two-level segregated fit (Masmano et al. 2004) over an abstract [0, capacity) range: O(1)
+// allocate and free with bounded fragmentation. Bookkeeping lives outside the managed range,
+// since that range is GPU memory we never touch from the CPU. Not thread-safe.
+class Tlsf {
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    struct Range {
+        uint64_t offset = 0; // Aligned as requested
+        uint64_t size = 0;   // At least the requested size (small tails are not split off)
+        uint32_t node = INVALID;
+    };
+
+    explicit Tlsf(uint64_t capacity);
+
+    std::optional<Range> allocate(uint64_t size, uint64_t alignment);
+    void free(uint32_t node);
+
+    uint64_t capacity() const { return m_capacity; }
+    uint64_t used() const { return m_used; }
+    uint32_t allocation_count() const { return m_allocations; }
+    bool empty() const { return m_allocations == 0; }
+    // Walks the free lists: meant for reports, not hot paths
+    uint64_t largest_free() const;
+    uint32_t free_range_count() const;
+
+private:
+    static constexpr uint32_t SL_LOG2 = 5;                 // 32 second-level classes per power of two
+    static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+    static constexpr uint32_t SMALL_LOG2 = 8;              // Below 256 bytes: one linear first level
+    static constexpr uint32_t FL_COUNT = 64 - SMALL_LOG2 + 1;
+    static constexpr uint64_t MIN_SPLIT = 256;             // Smaller tails stay with the allocation
+
+    struct Node {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t prevPhys, nextPhys; // Address-ordered neighbours, for coalescing
+        uint32_t prevFree, nextFree; // Segregated free list links
+        bool free;
+    };
+
+    static std::pair<uint32_t, uint32_t> mapping(uint64_t size);
+    uint32_t find_free(uint64_t size) const;
+    void insert_free(uint32_t index);
+    void remove_free(uint32_t index);
+    uint32_t new_node(uint64_t offset, uint64_t size);
+    void release_node(uint32_t index);
+
+    uint64_t m_capacity;
+    uint64_t m_used = 0;
+    uint32_t m_allocations = 0;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_spareNodes;
+    uint64_t m_flBitmap = 0;
+    std::array<uint32_t, FL_COUNT> m_slBitmap{};
+    std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> m_heads;
+};
+
+} // namespace Zeta
@@ -0,0 +1,138 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "Zeta/gpu_allocator.hpp"
+#include "Zeta/metrics.hpp"
+
+namespace Zeta {
+
+// Streams data to the GPU on its own queue so large uploads overlap with frames instead of
+// adding to them. Data goes through a persistently mapped staging ring; copies are batched into
+// one submission per frame that signals the queue's own timeline semaphore.
+//  - Dedicated transfer family: every copy ends with a queue-family release barrier, and the
+//    graphics side records the matching acquire (record_acquires) once the batch has completed,
+//    waiting on the transfer timeline in the same submit. Frames never wait on unfinished uploads.
+//  - No separate family: the same batches go to the graphics queue, whose submission order plus
+//    a closing barrier stands in for the ownership transfer.
+// stage() and copy() are thread-safe; submit() and record_acquires() belong to the frame thread,
+// which owns the graphics queue used by the fallback.
+class TransferQueue {
+public:
+    // Space in the staging ring: write data, then hand it to copy()
+    struct Staging {
+        std::byte* data = nullptr;
+        vk::Buffer buffer;
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size = 0;
+        uint64_t id = 0;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    struct BufferCopy {
+        vk::Buffer buffer;
+        vk::DeviceSize offset = 0;
+        vk::PipelineStageFlags2 dstStage = vk::PipelineStageFlagBits2::eAllCommands;
+        vk::AccessFlags2 dstAccess = vk::AccessFlagBits2::eMemoryRead;
+    };
+
+    // The copied subresource region is overwritten whole: its old contents are discarded
+    struct ImageCopy {
+        vk::Image image;
+        vk::ImageSubresourceLayers subresource{ vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
+        vk::Offset3D offset{};
+        vk::Extent3D extent{};
+        vk::ImageLayout finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        vk::PipelineStageFlags2 dstStage = vk::PipelineStageFlagBits2::eFragmentShader;
+        vk::AccessFlags2 dstAccess = vk::AccessFlagBits2::eShaderSampledRead;
+    };
+
+    ~TransferQueue();
+
+    // queue belongs to queueFamily; pass the graphics queue and family when there is no other
+    void init(const vk::raii::Device& device, GpuAllocator& allocator, const vk::raii::Queue& queue, uint32_t queueFamily,
+              uint32_t graphicsFamily, vk::DeviceSize stagingSize);
+    bool dedicated() const { return m_queueFamily != m_graphicsFamily; }
+
+    // Empty when the ring is full; retry after a later frame has retired some uploads
+    Staging stage(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+    // Gives staging space back without copying it (no effect once copy() has used it)
+    void release(const Staging& staging);
+
+    // Record a copy into the open batch, flushing the staging range first on non-coherent memory.
+    // Returns its ticket: the transfer timeline value that signals when the copy is done;
+    // usable() tells when frames may use the destination.
+    uint64_t copy(const Staging& staging, const BufferCopy& dst);
+    uint64_t copy(const Staging& staging, const ImageCopy& dst);
+
+    // Frame thread: submits the open batch, if any, and returns the last submitted value
+    uint64_t submit();
+    // Frame thread, at the start of the frame's graphics commands: acquires every completed batch
+    // and returns the transfer timeline value the frame's submit must wait for (0: none)
+    uint64_t record_acquires(const vk::raii::CommandBuffer& cmd);
+    // True once frames recorded from now on may read what the ticket's copy wrote
+    bool usable(uint64_t ticket) const { return ticket <= m_acquired.load(std::memory_order_acquire); }
+
+    const vk::raii::Semaphore& timeline() const { return m_timeline; }
+    uint64_t completed() const { return m_timeline.getCounterValue(); }
+    vk::DeviceSize staging_capacity() const { return m_stagingSize; }
+    vk::DeviceSize staging_used() const;
+
+private:
+    struct Batch {
+        vk::raii::CommandBuffer cmd{nullptr};
+        uint64_t value = 0; // Timeline value it signals, 0 while recording
+    };
+    // A staging range in ring order, freed once its value has completed
+    struct StagingEntry {
+        vk::DeviceSize begin; // Including padding and any wrap-around waste before it
+        vk::DeviceSize end;
+        uint64_t value;       // PENDING until copied, 0 when released unused
+    };
+    struct Acquire {
+        uint64_t value;
+        std::vector<vk::BufferMemoryBarrier2> buffers;
+        std::vector<vk::ImageMemoryBarrier2> images;
+    };
+
+    static constexpr uint64_t PENDING = UINT64_MAX;
+
+    Batch& open_batch();
+    void reclaim_staging(uint64_t completed);
+    void mark_staging(const Staging& staging, uint64_t value);
+    vk::DeviceSize staging_used_locked() const;
+
+    const vk::raii::Device* m_device = nullptr;
+    GpuAllocator* m_allocator = nullptr;
+    const vk::raii::Queue* m_queue = nullptr;
+    uint32_t m_queueFamily = 0;
+    uint32_t m_graphicsFamily = 0;
+
+    mutable std::mutex m_mutex;
+    vk::raii::CommandPool m_pool{nullptr};
+    std::deque<Batch> m_batches;         // Deque: m_open points into it
+    Batch* m_open = nullptr;
+    Acquire m_openAcquire;                // Release barriers of the open batch, mirrored for the acquire
+    std::deque<Acquire> m_acquires;       // Submitted, not yet acquired by the graphics queue
+    vk::raii::Semaphore m_timeline{nullptr};
+    uint64_t m_submitted = 0;
+    std::atomic<uint64_t> m_acquired{0};  // Highest ticket frames may use
+
+    vk::raii::Buffer m_staging{nullptr};
+    GpuAllocation m_stagingMemory;
+    vk::DeviceSize m_stagingSize = 0;
+    std::deque<StagingEntry> m_stagingEntries;
+    uint64_t m_stagingFrontId = 0;        // id of m_stagingEntries.front()
+    vk::DeviceSize m_stagingHead = 0;
+
+    Counter& m_bytes = Metrics::get().counter("transfer_bytes");
+    Counter& m_batchCount = Metrics::get().counter("transfer_batches");
+    Counter& m_stagingFull = Metrics::get().counter("transfer_staging_full");
+    Gauge& m_stagingUsed = Metrics::get().gauge("transfer_staging_used_bytes");
+};
+
+} // namespace Zeta
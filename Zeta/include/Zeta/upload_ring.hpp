@@ -0,0 +1,83 @@
+#pragma once
+#include <vulkan/vulkan_raii.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Zeta/gpu_allocator.hpp"
+#include "Zeta/metrics.hpp"
+
+namespace Zeta {
+
+// Per-frame transient data (uniforms, push data too big for push constants, dynamic vertices)
+// written straight into one persistently mapped host-visible buffer. The buffer is split into one
+// region per frame-in-flight slot; a region is reused only once the frame timeline has passed the
+// frame that last wrote it. Allocation is a lock-free bump pointer, so recording threads can share
+// a frame's region. Nothing is allocated or mapped per frame.
+class UploadRing {
+public:
+    // A piece of this frame's region: write through data, bind buffer at offset
+    struct Slice {
+        std::byte* data = nullptr;
+        vk::Buffer buffer;
+        vk::DeviceSize offset = 0; // From the start of the buffer, for binds and dynamic offsets
+        vk::DeviceSize size = 0;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    void init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice, GpuAllocator& allocator,
+              const vk::raii::Semaphore& timeline, uint32_t regionCount, vk::DeviceSize regionSize);
+
+    // Starts filling the slot's region for the frame that will signal frameValue. Waits on the
+    // timeline only if the caller has not already waited past the region's previous frame.
+    void begin_frame(uint32_t slot, uint64_t frameValue, uint64_t completedValue);
+    // Makes this frame's writes visible to the device (non-coherent memory); call before submit
+    void end_frame();
+
+    // Empty slice on overrun: counted, reported at end_frame(), and the caller skips the work
+    Slice allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+    Slice uniform(vk::DeviceSize size) { return allocate(size, m_uniformAlignment); }
+    Slice storage(vk::DeviceSize size) { return allocate(size, m_storageAlignment); }
+    Slice vertices(vk::DeviceSize size) { return allocate(size, VERTEX_ALIGNMENT); }
+
+    template<typename T>
+    Slice push_uniform(const T& value) {
+        Slice slice = uniform(sizeof(T));
+        if (slice) std::memcpy(slice.data, &value, sizeof(T));
+        return slice;
+    }
+
+    vk::Buffer buffer() const { return *m_buffer; }
+    vk::DeviceSize region_size() const { return m_regionSize; }
+    // Bytes handed out from the current region so far
+    vk::DeviceSize used() const { return m_head.load(std::memory_order_relaxed); }
+    vk::DeviceSize uniform_alignment() const { return m_uniformAlignment; }
+
+private:
+    static constexpr vk::DeviceSize VERTEX_ALIGNMENT = 16;
+
+    GpuAllocator* m_allocator = nullptr;
+    const vk::raii::Device* m_device = nullptr;
+    const vk::raii::Semaphore* m_timeline = nullptr;
+    vk::raii::Buffer m_buffer{nullptr};
+    GpuAllocation m_memory;
+
+    vk::DeviceSize m_regionSize = 0;
+    vk::DeviceSize m_uniformAlignment = 1;
+    vk::DeviceSize m_storageAlignment = 1;
+    std::vector<uint64_t> m_regionFrames; // Timeline value each region was last written for
+
+    uint32_t m_slot = 0;
+    uint64_t m_frameValue = 0;
+    std::atomic<vk::DeviceSize> m_head{0};         // Offset within the current region
+    std::atomic<vk::DeviceSize> m_overrunBytes{0}; // Requested this frame but did not fit
+    std::atomic<uint32_t> m_overruns{0};
+    bool m_overrunning = false; // The previous frame overran too (frame thread only)
+
+    Histogram& m_frameBytes = Metrics::get().histogram("upload_ring_frame_bytes");
+    Counter& m_overrunCounter = Metrics::get().counter("upload_ring_overruns");
+    Counter& m_stalls = Metrics::get().counter("upload_ring_stalls");
+};
+
+} // namespace Zeta
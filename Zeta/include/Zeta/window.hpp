@@ -2,9 +2,12 @@
 
 #include <wayland-client.h>
 #include <functional>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include "Zeta/events.hpp"
+#include "Zeta/metrics.hpp"
 
 struct wl_display;
 struct wl_surface;
@@ -14,13 +17,26 @@ struct xdg_surface;
 struct xdg_toplevel;
 struct wl_seat;
 struct wl_keyboard;
+struct wl_pointer;
+struct wl_event_queue;
+struct wl_callback;
+struct zwp_relative_pointer_manager_v1;
+struct zwp_relative_pointer_v1;
+struct wp_presentation;
+struct wp_presentation_feedback;
+struct wp_viewporter;
+struct wp_viewport;
+struct wp_fractional_scale_manager_v1;
+struct wp_fractional_scale_v1;
 
 namespace Zeta {
 
 class Window {
 public:
     using ResizeCallback = std::function<void(uint32_t, uint32_t)>;
-    using KeyCallback = std::function<void(uint32_t, bool)>;
+    // Input callbacks receive fully formed events, timestamped with the compositor's event time
+    using KeyCallback = std::function<void(const KeyEvent&)>;
+    using PointerCallback = std::function<void(const CoreEvent&)>; // Position, relative motion, buttons
 
     Window(uint32_t width, uint32_t height);
     ~Window();
@@ -33,15 +49,59 @@ public:
     uint32_t m_height = 600;
 
 
+    // Swapchain (buffer) size: the logical surface size times the compositor's preferred scale
+    // times the render scale. 0 until the first configure; the resize callback reports changes.
     uint32_t m_physicalWidth = 0;
     uint32_t m_physicalHeight = 0;
-    void poll_events();
 
-    void update(Zeta::Event e);
+    // Fraction of the native pixel count per axis to render at, clamped to [MIN, MAX]_RENDER_SCALE.
+    // The compositor stretches the smaller buffer over the surface through wp_viewport, so this only
+    // costs a swapchain recreate. Without wp_viewporter the buffer must match the surface and the
+    // scale is ignored.
+    static constexpr float MIN_RENDER_SCALE = 0.25f;
+    static constexpr float MAX_RENDER_SCALE = 2.0f;
+    void set_render_scale(float scale);
+    float render_scale() const { return m_renderScale; }
+    // Scale the compositor would like buffers at (1.0 without wp_fractional_scale_v1)
+    double preferred_scale() const { return m_preferredScale120 / 120.0; }
+    bool has_viewport() const { return m_viewport != nullptr; }
+    // Reads and dispatches whatever the compositor has sent, waiting at most timeoutMs for it
+    // (0: never blocks, -1: until something arrives). Returns false once the connection is gone.
+    bool poll_events(int timeoutMs = 0);
+
+    // Moves seat input (keyboard, pointer) onto its own wl_event_queue, read and dispatched by a dedicated
+    // thread, so input is delivered as it arrives rather than when the frame loop next polls.
+    // Input callbacks then run on that thread: they must only touch thread-safe state (EventBus).
+    void start_input_thread();
+    void stop_input_thread();
+    bool has_input_thread() const { return m_inputThread.joinable(); }
+
+    void update(const Zeta::CoreEvent& e);
     
     // Setters for App-level callbacks
     void set_resize_callback(ResizeCallback cb) { m_onResize = std::move(cb); }
     void set_key_callback(KeyCallback cb) { m_onKey = std::move(cb); }
+    void set_pointer_callback(PointerCallback cb) { m_onPointer = std::move(cb); }
+
+    // Asks wp_presentation for feedback on the next surface commit (the swapchain present), so call
+    // it right before drawing. inputTimeNs is the earliest input event the frame consumed (0: none);
+    // once the frame is on screen the gap lands in the input_to_present_us histogram.
+    void track_frame(uint64_t frameId, uint64_t inputTimeNs);
+    // Frame-callback pacing: request_frame() asks the compositor (via the next commit, so call it
+    // right before drawing) to say when it wants another frame. Until it does, frame_pending() is
+    // true; a hidden or occluded surface may never get the callback, so the frame loop idles.
+    void request_frame();
+    // Drops the pending frame request and presentation feedback when the frame they were meant for
+    // never got committed
+    void cancel_frame();
+    bool frame_pending() const { return m_frameCallback != nullptr; }
+    // The compositor marked the toplevel suspended (xdg_toplevel state, e.g. minimised or on
+    // another workspace): nothing we draw will be shown
+    bool suspended() const { return m_suspended; }
+
+    bool has_presentation_feedback() const { return m_presentation != nullptr; }
+    uint64_t last_input_to_present_us() const { return m_lastInputToPresentUs; }
+    uint64_t last_presented_frame() const { return m_lastPresentedFrame; }
 
     void setOpaqueRegion(uint32_t width, uint32_t height);
     // Getters for Vulkan Surface creation
@@ -55,6 +115,16 @@ public:
     static void handle_xdg_surface_configure(void* data, struct xdg_surface* surf, uint32_t serial);
     static void handle_xdg_toplevel_configure(void* data, struct xdg_toplevel* top, int32_t w, int32_t h, struct wl_array* states);
     static void handle_keyboard_key(void* data, struct wl_keyboard* kbd, uint32_t ser, uint32_t time, uint32_t key, uint32_t state);
+    static void handle_pointer_motion(void* data, struct wl_pointer* ptr, uint32_t time, wl_fixed_t x, wl_fixed_t y);
+    static void handle_pointer_button(void* data, struct wl_pointer* ptr, uint32_t ser, uint32_t time, uint32_t button, uint32_t state);
+    static void handle_relative_motion(void* data, struct zwp_relative_pointer_v1* rel, uint32_t utimeHi, uint32_t utimeLo,
+                                       wl_fixed_t dx, wl_fixed_t dy, wl_fixed_t dxUnaccel, wl_fixed_t dyUnaccel);
+    static void handle_preferred_scale(void* data, struct wp_fractional_scale_v1* fs, uint32_t scale);
+    static void handle_frame_done(void* data, struct wl_callback* cb, uint32_t time);
+    static void handle_presentation_clock(void* data, struct wp_presentation* pres, uint32_t clockId);
+    static void handle_feedback_presented(void* data, struct wp_presentation_feedback* fb, uint32_t secHi, uint32_t secLo, uint32_t nsec,
+                                          uint32_t refresh, uint32_t seqHi, uint32_t seqLo, uint32_t flags);
+    static void handle_feedback_discarded(void* data, struct wp_presentation_feedback* fb);
 
 private:
     // Wayland State
@@ -64,6 +134,9 @@ private:
     struct wl_surface*   m_surface = nullptr;
     struct wl_seat*       m_seat = nullptr;
     struct wl_keyboard*   m_keyboard = nullptr;
+    struct wl_pointer*    m_pointer = nullptr;
+    struct zwp_relative_pointer_manager_v1* m_relativePointerManager = nullptr;
+    struct zwp_relative_pointer_v1*         m_relativePointer = nullptr;
     struct wl_output* m_output = nullptr;
 
     // XDG Shell State
@@ -74,6 +147,47 @@ private:
     // Callbacks
     ResizeCallback m_onResize;
     KeyCallback    m_onKey;
+    PointerCallback m_onPointer;
+
+    // Scaling state: logical size comes from xdg_toplevel.configure, in surface coordinates
+    struct wp_viewporter* m_viewporter = nullptr;
+    struct wp_viewport*   m_viewport = nullptr;
+    struct wp_fractional_scale_manager_v1* m_fractionalScaleManager = nullptr;
+    struct wp_fractional_scale_v1*         m_fractionalScale = nullptr;
+    uint32_t m_logicalWidth = 0;
+    uint32_t m_logicalHeight = 0;
+    uint32_t m_preferredScale120 = 120; // Protocol unit: scale * 120
+    float m_renderScale = 1.0f;
+    void update_buffer_size();
+
+    // Frame pacing state
+    struct wl_callback* m_frameCallback = nullptr;
+    bool m_suspended = false;
+
+    // Presentation feedback: one pending request per tracked frame
+    struct FrameFeedback {
+        Window* window;
+        struct wp_presentation_feedback* feedback;
+        uint64_t frameId;
+        uint64_t inputTimeNs;
+    };
+    struct wp_presentation* m_presentation = nullptr;
+    uint32_t m_presentationClock = 1; // CLOCK_MONOTONIC until the compositor says otherwise
+    std::vector<std::unique_ptr<FrameFeedback>> m_feedback;
+    FrameFeedback* m_lastTracked = nullptr; // Latest track_frame() request, until it completes
+    uint64_t m_lastInputToPresentUs = 0;
+    uint64_t m_lastPresentedFrame = 0;
+    void finish_feedback(FrameFeedback* fb);
+
+    Histogram& m_inputToPresent = Metrics::get().histogram("input_to_present_us");
+    Counter& m_framesPresented = Metrics::get().counter("frames_presented");
+    Counter& m_framesDiscarded = Metrics::get().counter("frames_discarded");
+
+    // Input thread state
+    struct wl_event_queue* m_inputQueue = nullptr;
+    std::jthread m_inputThread;
+    int m_wakeFd = -1; // eventfd that breaks the input thread out of poll()
+    void input_loop(std::stop_token stop);
 
     // Internal initialization helpers
     void init_wayland(uint32_t w, uint32_t h);
@@ -0,0 +1,251 @@
+#include "Zeta/jobs.hpp"
+#include "Zeta/metrics.hpp"
+#include "Zeta/profiler.hpp"
+#include <format>
+#include <print>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Zeta {
+
+namespace {
+
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+}
+
+static thread_local int32_t t_threadIndex = -1;
+static thread_local uint32_t t_depth = 0; // Jobs run from inside wait() nest; only the outermost counts as busy
+
+Jobs& Jobs::get() {
+    static Jobs instance;
+    return instance;
+}
+
+Jobs::~Jobs() {
+    shutdown();
+}
+
+int32_t Jobs::thread_index() {
+    return t_threadIndex;
+}
+
+void Jobs::init(uint32_t workerCount, bool pinThreads) {
+    if (running()) return;
+
+    uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+    if (workerCount == 0) workerCount = cores - 1;
+
+    // 1. Slot 0 belongs to the calling (main) thread, 1..N to workers
+    for (uint32_t i = 0; i <= workerCount; ++i) m_slots.push_back(std::make_unique<Slot>());
+    t_threadIndex = 0;
+    m_statsStartNs = Profiler::now_ns();
+
+    // 2. One pinned worker per remaining core. Core 0 is left free for the main thread, which is
+    //    not pinned itself: the OS may still move it.
+    for (uint32_t i = 1; i <= workerCount; ++i) {
+        m_workers.emplace_back([this, i](std::stop_token stop) { worker_loop(stop, i); });
+        if (pinThreads && cores > 1) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cores, &set);
+            pthread_setaffinity_np(m_workers.back().native_handle(), sizeof(set), &set);
+        }
+    }
+
+    std::println("jobs: {} worker(s){}", workerCount, pinThreads && cores > 1 ? ", pinned" : "");
+}
+
+void Jobs::shutdown() {
+    if (!running()) return;
+
+    for (auto& worker : m_workers) worker.request_stop();
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_epoch.notify_all();
+    m_workers.clear();
+
+    // Anything still queued runs here rather than leaking counters that someone may wait on
+    while (Job* job = find_job(0)) execute(job, 0);
+    m_slots.clear();
+    t_threadIndex = -1;
+}
+
+void Jobs::run(std::function<void()> fn, JobCounter* counter) {
+    if (counter) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job{ std::move(fn), counter };
+    int32_t self = t_threadIndex;
+    if (!running()) {
+        execute(job, -1);
+        return;
+    }
+
+    // 1. Own deque when we are a participant, otherwise the injection queue
+    if (self >= 0) {
+        if (!m_slots[self]->deque.push(job)) {
+            execute(job, self); // Deque full: run inline, which is what a spawn would degrade to anyway
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        m_inject.push_back(job);
+        m_injected.fetch_add(1, std::memory_order_release);
+    }
+
+    // 2. Wake a sleeper only if there is one; the epoch bump keeps a late sleeper from missing it
+    m_epoch.fetch_add(1, std::memory_order_release);
+    if (m_sleeping.load(std::memory_order_acquire) > 0) m_epoch.notify_one();
+}
+
+Jobs::Job* Jobs::find_job(int32_t self) {
+    // 1. Own work first, newest first
+    if (self >= 0) {
+        if (Job* job = m_slots[self]->deque.pop()) return job;
+    }
+
+    // 2. Work injected from outside the pool. The count skips the lock when there is none, and
+    //    the lock is taken outright: giving up on contention could park a worker beside a queued job.
+    if (m_injected.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        if (!m_inject.empty()) {
+            Job* job = m_inject.front();
+            m_inject.pop_front();
+            m_injected.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // 3. Steal, starting after ourselves so thieves spread over victims
+    uint32_t count = static_cast<uint32_t>(m_slots.size());
+    uint32_t start = self >= 0 ? static_cast<uint32_t>(self) + 1 : 0;
+    for (uint32_t n = 0; n < count; ++n) {
+        uint32_t victim = (start + n) % count;
+        if (static_cast<int32_t>(victim) == self) continue;
+        if (Job* job = m_slots[victim]->deque.steal()) {
+            if (self >= 0) m_slots[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void Jobs::execute(Job* job, int32_t self) {
+    uint64_t start = Profiler::now_ns();
+    ++t_depth;
+    try {
+        job->fn();
+    } catch (...) {
+        // Never let it unwind past the bookkeeping below: the counter would never reach zero
+        JobCounter* counter = job->counter;
+        if (!counter) {
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                std::println("job failed: {}", e.what());
+            } catch (...) {
+                std::println("job failed: unknown exception");
+            }
+        } else if (!counter->m_failed.exchange(true, std::memory_order_relaxed)) {
+            counter->m_error = std::current_exception();
+        }
+    }
+    --t_depth;
+    if (job->counter) job->counter->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+    delete job;
+
+    if (t_depth == 0 && self >= 0 && self < static_cast<int32_t>(m_slots.size())) {
+        Slot& slot = *m_slots[self];
+        slot.busyNs.fetch_add(Profiler::now_ns() - start, std::memory_order_relaxed);
+        slot.executed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Jobs::wait(JobCounter& counter) {
+    ZETA_ZONE("Jobs::wait");
+    int32_t self = t_threadIndex;
+    uint32_t idleSpins = 0;
+    while (!counter.done()) {
+        // Help instead of blocking: whatever we pick up may well be what we are waiting for
+        if (Job* job = running() ? find_job(self) : nullptr) {
+            execute(job, self);
+            idleSpins = 0;
+        } else if (++idleSpins < 64) {
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    if (counter.m_failed.load(std::memory_order_relaxed)) {
+        // m_error was published by the acq_rel decrement that done() acquired
+        counter.m_failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(std::exchange(counter.m_error, nullptr));
+    }
+}
+
+void Jobs::worker_loop(std::stop_token stop, uint32_t index) {
+    t_threadIndex = static_cast<int32_t>(index);
+    ZETA_THREAD_NAME(std::format("job_worker_{}", index).c_str());
+
+    while (!stop.stop_requested()) {
+        // 1. Snapshot the epoch before looking, so a push that lands after the search wakes us
+        uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+
+        if (Job* job = find_job(static_cast<int32_t>(index))) {
+            execute(job, static_cast<int32_t>(index));
+            continue;
+        }
+
+        // 2. Brief spin: fork/join bursts usually refill the deques within microseconds
+        bool found = false;
+        for (uint32_t spin = 0; spin < 256 && !found; ++spin) {
+            cpu_relax();
+            found = m_epoch.load(std::memory_order_relaxed) != epoch;
+        }
+        if (found) continue;
+
+        // 3. Sleep until run() moves the epoch
+        m_sleeping.fetch_add(1, std::memory_order_acq_rel);
+        if (!stop.stop_requested()) m_epoch.wait(epoch, std::memory_order_acquire);
+        m_sleeping.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+std::vector<Jobs::WorkerStats> Jobs::stats() {
+    std::vector<WorkerStats> result;
+    uint64_t now = Profiler::now_ns();
+    double windowNs = static_cast<double>(std::max<uint64_t>(1, now - m_statsStartNs));
+    m_statsStartNs = now;
+
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        Slot& slot = *m_slots[i];
+        uint64_t busy = slot.busyNs.load(std::memory_order_relaxed);
+        uint64_t stolen = slot.stolen.load(std::memory_order_relaxed);
+
+        WorkerStats stats{
+            .utilization = std::min(1.0, static_cast<double>(busy - slot.lastBusyNs) / windowNs),
+            .executed = slot.executed.load(std::memory_order_relaxed),
+            .stolen = stolen - slot.lastStolen
+        };
+        slot.lastBusyNs = busy;
+        slot.lastStolen = stolen;
+
+        Metrics::get().gauge(std::format("job_worker_{}_utilization", i)).set(stats.utilization);
+        result.push_back(stats);
+    }
+    return result;
+}
+
+} // namespace Zeta
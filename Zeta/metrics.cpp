@@ -0,0 +1,193 @@
+#include "Zeta/metrics.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <print>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Zeta {
+
+// --- Histogram ---
+
+uint32_t Histogram::bucket_index(uint64_t value) {
+    value = std::min<uint64_t>(value, (1ull << MAX_BITS) - 1);
+    if (value < SUB_COUNT) return static_cast<uint32_t>(value);
+
+    // Shift so the top SUB_BITS bits remain: sub lands in [SUB_COUNT/2, SUB_COUNT)
+    uint32_t msb = 63 - static_cast<uint32_t>(std::countl_zero(value));
+    uint32_t shift = msb - SUB_BITS + 1;
+    uint32_t sub = static_cast<uint32_t>(value >> shift);
+    return SUB_COUNT + (shift - 1) * (SUB_COUNT / 2) + (sub - SUB_COUNT / 2);
+}
+
+uint64_t Histogram::bucket_midpoint(uint32_t index) {
+    if (index < SUB_COUNT) return index;
+
+    uint32_t k = index - SUB_COUNT;
+    uint32_t shift = k / (SUB_COUNT / 2) + 1;
+    uint64_t sub = k % (SUB_COUNT / 2) + SUB_COUNT / 2;
+    uint64_t lower = sub << shift;
+    uint64_t upper = ((sub + 1) << shift) - 1;
+    return lower + (upper - lower) / 2;
+}
+
+void Histogram::record(uint64_t value) {
+    m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = m_max.load(std::memory_order_relaxed);
+    while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+double Histogram::mean() const {
+    uint64_t n = count();
+    return n ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+}
+
+uint64_t Histogram::quantile(double q) const {
+    // Buckets are read without a snapshot lock, so use their own total rather than m_count
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets) total += bucket.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    auto rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucket_midpoint(i), max());
+    }
+    return max();
+}
+
+void Histogram::reset() {
+    for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+// --- Registry ---
+
+Metrics& Metrics::get() {
+    static Metrics instance;
+    return instance;
+}
+
+Metrics::~Metrics() {
+    stop();
+}
+
+template<typename T>
+static T& find_or_create(std::map<std::string, std::unique_ptr<T>, std::less<>>& map, std::string_view name) {
+    auto it = map.find(name);
+    if (it == map.end()) it = map.emplace(std::string(name), std::make_unique<T>()).first;
+    return *it->second;
+}
+
+Counter& Metrics::counter(std::string_view name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find_or_create(m_counters, name);
+}
+
+Gauge& Metrics::gauge(std::string_view name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find_or_create(m_gauges, name);
+}
+
+Histogram& Metrics::histogram(std::string_view name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find_or_create(m_histograms, name);
+}
+
+std::string Metrics::snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ostringstream out;
+
+    for (const auto& [name, counter] : m_counters) {
+        out << "# TYPE zeta_" << name << " counter\n";
+        out << "zeta_" << name << " " << counter->value() << "\n";
+    }
+    for (const auto& [name, gauge] : m_gauges) {
+        out << "# TYPE zeta_" << name << " gauge\n";
+        out << "zeta_" << name << " " << gauge->value() << "\n";
+    }
+    for (const auto& [name, histogram] : m_histograms) {
+        out << "# TYPE zeta_" << name << " summary\n";
+        for (double q : { 0.5, 0.9, 0.99, 0.999 }) {
+            out << "zeta_" << name << "{quantile=\"" << q << "\"} " << histogram->quantile(q) << "\n";
+        }
+        out << "zeta_" << name << "_max " << histogram->max() << "\n";
+        out << "zeta_" << name << "_mean " << histogram->mean() << "\n";
+        out << "zeta_" << name << "_count " << histogram->count() << "\n";
+    }
+    return out.str();
+}
+
+bool Metrics::serve(std::string path) {
+    if (m_server.joinable()) return true;
+
+    // 1. Resolve the socket path
+    if (path.empty()) {
+        const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+        path = std::string(runtimeDir ? runtimeDir : "/tmp") + "/zeta-" + std::to_string(getpid()) + ".sock";
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // 2. Bind and listen
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return false;
+    }
+    m_listenFd = fd;
+    m_socketPath = path;
+
+    // 3. Answer each connection with one snapshot, never touching the frame thread
+    m_server = std::jthread([this](std::stop_token stop) {
+        while (!stop.stop_requested()) {
+            pollfd pfd{ .fd = m_listenFd, .events = POLLIN, .revents = 0 };
+            if (poll(&pfd, 1, 200) <= 0) continue;
+
+            int client = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) continue;
+
+            std::string text = snapshot();
+            size_t sent = 0;
+            while (sent < text.size()) {
+                ssize_t n = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                sent += static_cast<size_t>(n);
+            }
+            close(client);
+        }
+    });
+
+    std::println("metrics: serving on {}", m_socketPath);
+    return true;
+}
+
+void Metrics::stop() {
+    if (m_server.joinable()) {
+        m_server.request_stop();
+        m_server.join();
+    }
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(m_socketPath.c_str());
+        m_listenFd = -1;
+    }
+}
+
+} // namespace Zeta
@@ -0,0 +1,165 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/pipeline_cache.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <print>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Zeta {
+
+static uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::filesystem::path PipelineCache::default_directory() {
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+        return std::filesystem::path(cacheHome) / "zeta";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path(home) / ".cache" / "zeta";
+    }
+    return std::filesystem::temp_directory_path() / "zeta";
+}
+
+void PipelineCache::init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice) {
+    m_device = &device;
+
+    // 1. Identify the blob: the driver only promises compatibility for the same UUID and driver
+    auto props = physicalDevice.getProperties();
+    m_header = FileHeader{
+        .magic = MAGIC,
+        .version = VERSION,
+        .vendorID = props.vendorID,
+        .deviceID = props.deviceID,
+        .driverVersion = props.driverVersion,
+        .pipelineCacheUUID = {},
+        .reserved = 0,
+        .dataSize = 0,
+        .dataHash = 0
+    };
+    std::memcpy(m_header.pipelineCacheUUID.data(), props.pipelineCacheUUID.data(), VK_UUID_SIZE);
+    m_path = default_directory() / std::format("pipelines-{:04x}-{:04x}.bin", props.vendorID, props.deviceID);
+
+    // 2. Seed from disk; a stale or corrupt file just means a cold start
+    std::vector<uint8_t> data = read_file();
+    m_loadedBytes = data.size();
+
+    m_cache = vk::raii::PipelineCache(device, vk::PipelineCacheCreateInfo{
+        .initialDataSize = data.size(),
+        .pInitialData = data.empty() ? nullptr : data.data()
+    });
+
+    std::println("pipeline cache: {} ({})", m_path.string(),
+        warm() ? std::format("warm, {} bytes", m_loadedBytes) : std::string("cold"));
+}
+
+std::vector<uint8_t> PipelineCache::read_file() const {
+    std::ifstream file(m_path, std::ios::binary);
+    if (!file) return {};
+
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return {};
+
+    bool matches = header.magic == MAGIC && header.version == VERSION &&
+        header.vendorID == m_header.vendorID && header.deviceID == m_header.deviceID &&
+        header.driverVersion == m_header.driverVersion &&
+        header.pipelineCacheUUID == m_header.pipelineCacheUUID;
+    if (!matches) {
+        std::println("pipeline cache: {} is from another device or driver, ignoring", m_path.string());
+        return {};
+    }
+
+    // Check the claimed size against what the file holds before allocating for it
+    auto dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    auto remaining = static_cast<uint64_t>(file.tellg() - dataStart);
+    file.seekg(dataStart);
+    if (header.dataSize == 0 || header.dataSize > MAX_DATA_SIZE || header.dataSize > remaining) {
+        std::println("pipeline cache: {} is truncated or corrupt, ignoring", m_path.string());
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.dataSize);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())) ||
+        fnv1a(data.data(), data.size()) != header.dataHash) {
+        std::println("pipeline cache: {} is truncated or corrupt, ignoring", m_path.string());
+        return {};
+    }
+    return data;
+}
+
+bool PipelineCache::save() {
+    if (!*m_cache) return false;
+    // Called from the Renderer destructor: report, never throw
+    try {
+        return write_file();
+    } catch (const std::exception& e) {
+        std::println("pipeline cache: save failed: {}", e.what());
+    } catch (...) {
+        std::println("pipeline cache: save failed");
+    }
+    return false;
+}
+
+bool PipelineCache::write_file() {
+    // 1. Another instance may have saved since we loaded: fold its pipelines into ours
+    std::vector<uint8_t> onDisk = read_file();
+    if (!onDisk.empty()) {
+        vk::raii::PipelineCache other(*m_device, vk::PipelineCacheCreateInfo{
+            .initialDataSize = onDisk.size(),
+            .pInitialData = onDisk.data()
+        });
+        m_cache.merge(*other);
+    }
+    std::vector<uint8_t> data = m_cache.getData();
+    if (data.empty()) return false;
+
+    FileHeader header = m_header;
+    header.dataSize = data.size();
+    header.dataHash = fnv1a(data.data(), data.size());
+
+    // 2. Write a sibling temp file, fsync, then rename over the old one: readers see old or new, never half
+    std::error_code ec;
+    std::filesystem::create_directories(m_path.parent_path(), ec);
+    std::filesystem::path tmpPath = m_path;
+    tmpPath += std::format(".{}.tmp", getpid());
+
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::println("pipeline cache: cannot write {}", tmpPath.string());
+        return false;
+    }
+
+    auto writeAll = [fd](const void* bytes, size_t size) {
+        auto* p = static_cast<const uint8_t*>(bytes);
+        while (size > 0) {
+            ssize_t n = write(fd, p, size);
+            if (n <= 0) return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    };
+
+    bool ok = writeAll(&header, sizeof(header)) && writeAll(data.data(), data.size()) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmpPath.c_str(), m_path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        std::println("pipeline cache: failed to save {}", m_path.string());
+        return false;
+    }
+
+    std::println("pipeline cache: saved {} bytes to {}", data.size(), m_path.string());
+    return true;
+}
+
+} // namespace Zeta
@@ -0,0 +1,333 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/pipeline_registry.hpp"
+#include "Zeta/profiler.hpp"
+#include "Zeta/render.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <print>
+#include <string_view>
+
+namespace Zeta {
+
+// --- Hashing ---
+
+namespace {
+
+// FNV-1a over the fields that feed a pipeline (or one library part of it)
+struct Hasher {
+    uint64_t value = 0xcbf29ce484222325ull;
+
+    Hasher& add(const void* data, size_t size) {
+        auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            value ^= bytes[i];
+            value *= 0x100000001b3ull;
+        }
+        return *this;
+    }
+    Hasher& add(std::string_view s) { add(s.data(), s.size()); return add(uint64_t{s.size()}); }
+    Hasher& add(uint64_t v) { return add(&v, sizeof(v)); }
+};
+
+uint64_t as_int(vk::PipelineLayout layout) {
+    return reinterpret_cast<uint64_t>(static_cast<VkPipelineLayout>(layout));
+}
+
+}
+
+uint64_t GraphicsPipelineDesc::vertex_input_hash() const {
+    return Hasher{}.add(1).add(static_cast<uint64_t>(topology)).value;
+}
+
+uint64_t GraphicsPipelineDesc::pre_raster_hash() const {
+    return Hasher{}.add(2).add(vertexShader).add(as_int(layout))
+        .add(static_cast<uint64_t>(polygonMode))
+        .add(static_cast<uint64_t>(static_cast<VkCullModeFlags>(cullMode)))
+        .add(static_cast<uint64_t>(frontFace)).value;
+}
+
+uint64_t GraphicsPipelineDesc::fragment_shader_hash() const {
+    return Hasher{}.add(3).add(fragmentShader).add(as_int(layout))
+        .add(depthTest).add(depthWrite).add(static_cast<uint64_t>(depthCompare)).value;
+}
+
+uint64_t GraphicsPipelineDesc::fragment_output_hash() const {
+    return Hasher{}.add(4)
+        .add(static_cast<uint64_t>(colorFormat)).add(static_cast<uint64_t>(depthFormat))
+        .add(blendEnable)
+        .add(static_cast<uint64_t>(srcColorFactor)).add(static_cast<uint64_t>(dstColorFactor))
+        .add(static_cast<uint64_t>(colorBlendOp))
+        .add(static_cast<uint64_t>(srcAlphaFactor)).add(static_cast<uint64_t>(dstAlphaFactor))
+        .add(static_cast<uint64_t>(alphaBlendOp))
+        .add(static_cast<uint64_t>(static_cast<VkColorComponentFlags>(colorWriteMask))).value;
+}
+
+uint64_t GraphicsPipelineDesc::hash() const {
+    return Hasher{}.add(vertex_input_hash()).add(pre_raster_hash())
+        .add(fragment_shader_hash()).add(fragment_output_hash()).value;
+}
+
+// --- Create info assembly ---
+
+namespace {
+
+// All fixed-function state for one desc. Library builds pass the whole set: Vulkan only reads
+// the state that belongs to the parts being created.
+struct PipelineStateBlock {
+    vk::raii::ShaderModule vertModule{nullptr};
+    vk::raii::ShaderModule fragModule{nullptr};
+    std::vector<vk::PipelineShaderStageCreateInfo> stages;
+
+    vk::PipelineVertexInputStateCreateInfo vertexInput{};
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly{};
+    std::array<vk::DynamicState, 2> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+    vk::PipelineDynamicStateCreateInfo dynamicState{};
+    vk::PipelineViewportStateCreateInfo viewportState{ .viewportCount = 1, .scissorCount = 1 };
+    vk::PipelineRasterizationStateCreateInfo rasterizer{};
+    vk::PipelineMultisampleStateCreateInfo multisampling{ .rasterizationSamples = vk::SampleCountFlagBits::e1 };
+    vk::PipelineDepthStencilStateCreateInfo depthStencil{};
+    vk::PipelineColorBlendAttachmentState blendAttachment{};
+    vk::PipelineColorBlendStateCreateInfo colorBlending{};
+    vk::PipelineRenderingCreateInfo renderingInfo{};
+
+    PipelineStateBlock(const vk::raii::Device& device, const GraphicsPipelineDesc& desc, bool vertex, bool fragment) {
+        // 1. Shader modules, only for the stages this build needs
+        if (vertex) {
+            auto code = load_spirv(desc.vertexShader);
+            vertModule = vk::raii::ShaderModule(device, vk::ShaderModuleCreateInfo{
+                .codeSize = code.size() * sizeof(uint32_t), .pCode = code.data()
+            });
+            stages.push_back({ .stage = vk::ShaderStageFlagBits::eVertex, .module = *vertModule, .pName = "main" });
+        }
+        if (fragment) {
+            auto code = load_spirv(desc.fragmentShader);
+            fragModule = vk::raii::ShaderModule(device, vk::ShaderModuleCreateInfo{
+                .codeSize = code.size() * sizeof(uint32_t), .pCode = code.data()
+            });
+            stages.push_back({ .stage = vk::ShaderStageFlagBits::eFragment, .module = *fragModule, .pName = "main" });
+        }
+
+        // 2. Fixed function state from the desc
+        inputAssembly.topology = desc.topology;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        rasterizer.polygonMode = desc.polygonMode;
+        rasterizer.cullMode = desc.cullMode;
+        rasterizer.frontFace = desc.frontFace;
+        rasterizer.lineWidth = 1.0f;
+
+        depthStencil.depthTestEnable = desc.depthTest;
+        depthStencil.depthWriteEnable = desc.depthWrite;
+        depthStencil.depthCompareOp = desc.depthCompare;
+
+        blendAttachment = {
+            .blendEnable = desc.blendEnable,
+            .srcColorBlendFactor = desc.srcColorFactor,
+            .dstColorBlendFactor = desc.dstColorFactor,
+            .colorBlendOp = desc.colorBlendOp,
+            .srcAlphaBlendFactor = desc.srcAlphaFactor,
+            .dstAlphaBlendFactor = desc.dstAlphaFactor,
+            .alphaBlendOp = desc.alphaBlendOp,
+            .colorWriteMask = desc.colorWriteMask
+        };
+        colorBlending.attachmentCount = 1;
+        colorBlending.pAttachments = &blendAttachment;
+
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachmentFormats = &desc.colorFormat;
+        renderingInfo.depthAttachmentFormat = desc.depthFormat;
+    }
+
+    vk::GraphicsPipelineCreateInfo create_info(const GraphicsPipelineDesc& desc, const void* pNext) const {
+        return {
+            .pNext = pNext,
+            .stageCount = static_cast<uint32_t>(stages.size()),
+            .pStages = stages.empty() ? nullptr : stages.data(),
+            .pVertexInputState = &vertexInput,
+            .pInputAssemblyState = &inputAssembly,
+            .pViewportState = &viewportState,
+            .pRasterizationState = &rasterizer,
+            .pMultisampleState = &multisampling,
+            .pDepthStencilState = &depthStencil,
+            .pColorBlendState = &colorBlending,
+            .pDynamicState = &dynamicState,
+            .layout = desc.layout,
+            .renderPass = nullptr
+        };
+    }
+};
+
+}
+
+// --- Registry ---
+
+PipelineRegistry::~PipelineRegistry() {
+    shutdown();
+}
+
+void PipelineRegistry::init(const vk::raii::Device& device, const vk::raii::PipelineCache& cache, bool useLibraries, uint32_t workerCount) {
+    m_device = &device;
+    m_cache = &cache;
+    m_useLibraries = useLibraries;
+
+    if (workerCount == 0) {
+        // Leave a core for the frame thread; drivers rarely scale past a handful of compiles
+        workerCount = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+    }
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this](std::stop_token stop) { worker_loop(stop); });
+    }
+
+    std::println("pipeline registry: {} worker(s), {}", workerCount,
+        m_useLibraries ? "graphics pipeline libraries" : "monolithic pipelines");
+}
+
+void PipelineRegistry::shutdown() {
+    for (auto& worker : m_workers) worker.request_stop();
+    m_workAvailable.notify_all();
+    m_workers.clear(); // Joins
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Entry* entry : m_queue) entry->status.store(PipelineStatus::Failed, std::memory_order_release);
+    m_queue.clear();
+    m_workDone.notify_all();
+}
+
+PipelineRegistry::Handle PipelineRegistry::request(const GraphicsPipelineDesc& desc) {
+    m_requests.add();
+    uint64_t hash = desc.hash();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // 1. Identical request already known (pending or built): share it
+    auto [first, last] = m_lookup.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (it->second->desc == desc) {
+            m_dedupHits.add();
+            return Handle(it->second);
+        }
+    }
+
+    // 2. New permutation: queue it for the workers
+    Entry& entry = m_entries.emplace_back();
+    entry.desc = desc;
+    entry.hash = hash;
+    m_lookup.emplace(hash, &entry);
+
+    if (m_workers.empty()) {
+        entry.status.store(PipelineStatus::Failed, std::memory_order_release);
+        std::println("pipeline registry: request before init()");
+    } else {
+        m_queue.push_back(&entry);
+        m_workAvailable.notify_one();
+    }
+    return Handle(&entry);
+}
+
+vk::Pipeline PipelineRegistry::wait(Handle handle) {
+    if (!handle.valid()) return {};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [&] { return handle.status() != PipelineStatus::Pending; });
+    return handle.pipeline();
+}
+
+size_t PipelineRegistry::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t PipelineRegistry::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(std::ranges::count_if(m_entries, [](const Entry& e) {
+        return e.status.load(std::memory_order_relaxed) == PipelineStatus::Pending;
+    }));
+}
+
+void PipelineRegistry::worker_loop(std::stop_token stop) {
+    ZETA_THREAD_NAME("pipeline_worker");
+    while (true) {
+        Entry* entry = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workAvailable.wait(lock, [&] { return stop.stop_requested() || !m_queue.empty(); });
+            if (stop.stop_requested()) return;
+            entry = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        compile(*entry);
+
+        // Publish under the lock so wait() cannot miss the wakeup
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        m_workDone.notify_all();
+    }
+}
+
+void PipelineRegistry::compile(Entry& entry) {
+    ZETA_ZONE("pipeline_compile");
+    auto start = std::chrono::steady_clock::now();
+    try {
+        entry.pipeline = m_useLibraries ? build_linked(entry.desc) : build_monolithic(entry.desc);
+        m_compileTime.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        entry.status.store(PipelineStatus::Ready, std::memory_order_release);
+    } catch (const std::exception& e) {
+        m_failures.add();
+        std::println("pipeline registry: {} + {} failed: {}", entry.desc.vertexShader, entry.desc.fragmentShader, e.what());
+        entry.status.store(PipelineStatus::Failed, std::memory_order_release);
+    }
+}
+
+vk::raii::Pipeline PipelineRegistry::build_monolithic(const GraphicsPipelineDesc& desc) {
+    PipelineStateBlock state(*m_device, desc, true, true);
+    auto info = state.create_info(desc, &state.renderingInfo);
+    return vk::raii::Pipeline(*m_device, *m_cache, info);
+}
+
+vk::Pipeline PipelineRegistry::get_library(vk::GraphicsPipelineLibraryFlagBitsEXT part, uint64_t key, const GraphicsPipelineDesc& desc) {
+    {
+        std::lock_guard<std::mutex> lock(m_libraryMutex);
+        if (auto it = m_libraries.find(key); it != m_libraries.end()) return *it->second;
+    }
+
+    // 1. Build only the stages this part owns
+    bool vertex = part == vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders;
+    bool fragment = part == vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader;
+    PipelineStateBlock state(*m_device, desc, vertex, fragment);
+
+    vk::GraphicsPipelineLibraryCreateInfoEXT libraryInfo{
+        .pNext = &state.renderingInfo,
+        .flags = part
+    };
+    auto info = state.create_info(desc, &libraryInfo);
+    info.flags = vk::PipelineCreateFlagBits::eLibraryKHR | vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+    vk::raii::Pipeline library(*m_device, *m_cache, info);
+
+    // 2. Another worker may have finished the same part first; keep theirs
+    std::lock_guard<std::mutex> lock(m_libraryMutex);
+    auto [it, inserted] = m_libraries.try_emplace(key, std::move(library));
+    return *it->second;
+}
+
+vk::raii::Pipeline PipelineRegistry::build_linked(const GraphicsPipelineDesc& desc) {
+    std::array<vk::Pipeline, 4> libraries = {
+        get_library(vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface, desc.vertex_input_hash(), desc),
+        get_library(vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders, desc.pre_raster_hash(), desc),
+        get_library(vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader, desc.fragment_shader_hash(), desc),
+        get_library(vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface, desc.fragment_output_hash(), desc)
+    };
+
+    // Fast link without link-time optimization: this is the step a new permutation waits on
+    vk::PipelineLibraryCreateInfoKHR linkInfo{
+        .libraryCount = static_cast<uint32_t>(libraries.size()),
+        .pLibraries = libraries.data()
+    };
+    vk::GraphicsPipelineCreateInfo info{
+        .pNext = &linkInfo,
+        .layout = desc.layout
+    };
+    return vk::raii::Pipeline(*m_device, *m_cache, info);
+}
+
+} // namespace Zeta
@@ -0,0 +1,96 @@
+#include "Zeta/profiler.hpp"
+#include <algorithm>
+#include <fstream>
+
+namespace Zeta {
+
+Profiler& Profiler::get() {
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::ThreadBuffer& Profiler::thread_buffer() {
+    // Registered once per thread; the collector keeps the buffer alive after the thread exits
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [this] {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        created->id = static_cast<uint32_t>(m_threads.size());
+        created->name = "thread " + std::to_string(created->id);
+        m_threads.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer& buffer = thread_buffer();
+
+    size_t head = buffer.head.load(std::memory_order_relaxed);
+    size_t tail = buffer.tail.load(std::memory_order_acquire);
+    if (head - tail >= THREAD_BUFFER_SIZE) {
+        // Nobody flushed in time; losing zones beats blocking the instrumented thread
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.ring[head % THREAD_BUFFER_SIZE] = { name, startNs, endNs, buffer.id };
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(const char* name) {
+    ThreadBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer.name = name;
+}
+
+void Profiler::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& buffer : m_threads) {
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        size_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            m_collected.push_back(buffer->ring[tail % THREAD_BUFFER_SIZE]);
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    if (m_collected.size() > MAX_COLLECTED) {
+        m_collected.erase(m_collected.begin(), m_collected.begin() + m_collected.size() / 2);
+    }
+}
+
+bool Profiler::write_chrome_trace(const std::string& path) {
+    flush();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    uint64_t base = UINT64_MAX;
+    for (const auto& zone : m_collected) base = std::min(base, zone.startNs);
+
+    file << "{\"traceEvents\":[";
+    bool first = true;
+
+    // 1. Thread names as metadata events
+    for (const auto& buffer : m_threads) {
+        file << (first ? "" : ",")
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+             << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+        first = false;
+    }
+
+    // 2. Complete events, microseconds relative to the oldest zone
+    for (const auto& zone : m_collected) {
+        file << (first ? "" : ",")
+             << "{\"name\":\"" << zone.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread
+             << ",\"ts\":" << static_cast<double>(zone.startNs - base) / 1000.0
+             << ",\"dur\":" << static_cast<double>(zone.endNs - zone.startNs) / 1000.0 << "}";
+        first = false;
+    }
+    file << "],\"displayTimeUnit\":\"ms\"}\n";
+    return file.good();
+}
+
+} // namespace Zeta
@@ -3,12 +3,20 @@
 #endif
 #define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
 #include "Zeta/render.hpp"
+#include "Zeta/profiler.hpp"
+#include "Zeta/scheduler.hpp"
 #include <iostream>
 #include <print>
 
 #include <vulkan/vulkan_raii.hpp>
 #include "xdg-shell-client-protocol.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <format>
 #include <fstream>
 
 namespace Zeta {
@@ -48,38 +56,108 @@ Renderer::Renderer() :
 
 }
 
+Renderer::~Renderer() {
+    // Reads in flight still target the staging ring
+    m_streamer.shutdown();
+    // Shutdown is the one place a full drain is fine: everything retired must be idle before it is freed
+    if (*m_device) m_device.waitIdle();
+    m_deletionQueue.flush();
+    m_recorder.shutdown();
+    // Let in-flight compiles land in the cache before it is written
+    m_pipelines.shutdown();
+    m_pipelineCache.save();
+    // Views go before the offscreen images they were created from
+    m_swapchainImageViews.clear();
+}
+
+void Renderer::set_frames_in_flight(uint32_t count) {
+    if (*m_device) {
+        std::println("set_frames_in_flight ignored: renderer already initialized");
+        return;
+    }
+    m_framesInFlight = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+}
+
+void Renderer::set_upload_ring_size(vk::DeviceSize bytes) {
+    if (*m_device) {
+        std::println("set_upload_ring_size ignored: renderer already initialized");
+        return;
+    }
+    m_uploadRingSize = std::max<vk::DeviceSize>(bytes, 4096);
+}
+
+void Renderer::set_recording_threads(uint32_t count) {
+    if (*m_device) {
+        std::println("set_recording_threads ignored: renderer already initialized");
+        return;
+    }
+    m_recordingThreads = std::min(count, 64u);
+}
+
 void Renderer::init(wl_display* display, wl_surface* surface, uint32_t width, uint32_t height) {
 
     m_instance = create_instance();
     m_surface = create_surface(display, surface);
     m_physicalDevice = create_physical_device();
+    m_queueFamilyIndex = find_queue_family();
+    find_async_families();
     m_device = create_logical_device();
+    m_allocator.init(m_device, m_physicalDevice);
+    m_residency.init(m_physicalDevice, m_allocator, m_memoryBudget);
     m_graphicsQueue = create_graphics_queue();
+    create_transfer_queue();
     m_swapchain = create_swapchain(width, height, nullptr);
     m_commandPool = create_command_pool();
     m_commandBuffers = create_command_buffers();
+    if (m_recordingThreads > 0) m_recorder.init(m_device, m_queueFamilyIndex, m_recordingThreads, m_framesInFlight);
+    create_query_pool();
 
     // 4. Initial Setup
     m_swapchainImages = m_swapchain.getImages();
     // 3. Create RAII ImageViews
-    m_swapchainImageViews.clear();
-    m_swapchainImageViews.reserve(m_swapchainImages.size());
-
-    for (auto image : m_swapchainImages) {
-        vk::ImageViewCreateInfo viewInfo{
-            .image = image,
-            .viewType = vk::ImageViewType::e2D,
-            .format = m_swapchainFormat,
-            .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
-        };
-        m_swapchainImageViews.emplace_back(m_device, viewInfo);
-    }
+    create_swapchain_image_views();
     create_sync_objects();
+    create_frame_resources();
+    if (m_drs.enabled()) create_scene_target();
 
+    m_pipelineCache.init(m_device, m_physicalDevice);
+    m_pipelines.init(m_device, m_pipelineCache.handle(), m_graphicsPipelineLibrary);
     create_graphics_pipeline();
     std::println("init renderer complete");
 }
 
+void Renderer::init_headless(uint32_t width, uint32_t height) {
+    // Same device, frames-in-flight and timeline setup as init(), minus the surface:
+    // the "swapchain" is a ring of offscreen images, one per frame-in-flight slot.
+    m_headless = true;
+
+    m_instance = create_instance();
+    m_physicalDevice = create_physical_device();
+    m_queueFamilyIndex = find_queue_family();
+    find_async_families();
+    m_device = create_logical_device();
+    m_allocator.init(m_device, m_physicalDevice);
+    m_residency.init(m_physicalDevice, m_allocator, m_memoryBudget);
+    m_graphicsQueue = create_graphics_queue();
+    create_transfer_queue();
+    create_offscreen_targets(width, height);
+    m_commandPool = create_command_pool();
+    m_commandBuffers = create_command_buffers();
+    if (m_recordingThreads > 0) m_recorder.init(m_device, m_queueFamilyIndex, m_recordingThreads, m_framesInFlight);
+    create_query_pool();
+
+    create_swapchain_image_views();
+    create_sync_objects();
+    create_frame_resources();
+    if (m_drs.enabled()) create_scene_target();
+
+    m_pipelineCache.init(m_device, m_physicalDevice);
+    m_pipelines.init(m_device, m_pipelineCache.handle(), m_graphicsPipelineLibrary);
+    create_graphics_pipeline();
+    std::println("init headless renderer complete ({}x{} on {})", width, height,
+        m_physicalDevice.getProperties().deviceName.data());
+}
+
 void Renderer::create_context() {
 }
 
@@ -92,13 +170,28 @@ vk::raii::Instance Renderer::create_instance() {
         .apiVersion = VK_API_VERSION_1_3 // Required field
     };
 
-    std::vector<const char*> layers = { "VK_LAYER_KHRONOS_validation" };
-    // 1. Define the required extensions for Wayland
-    std::vector<const char*> extensions = {
-        VK_KHR_SURFACE_EXTENSION_NAME,         // "VK_KHR_surface"
-        VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME,
-        VK_EXT_DEBUG_UTILS_EXTENSION_NAME  // "VK_KHR_wayland_surface"
-    };
+    // Validation and debug utils are used when installed, but not required: build machines
+    // running lavapipe/llvmpipe often ship only the ICD.
+    std::vector<const char*> layers;
+    for (const auto& layer : m_context.enumerateInstanceLayerProperties()) {
+        if (std::strcmp(layer.layerName.data(), "VK_LAYER_KHRONOS_validation") == 0) {
+            layers.push_back("VK_LAYER_KHRONOS_validation");
+        }
+    }
+
+    std::vector<const char*> extensions;
+    for (const auto& ext : m_context.enumerateInstanceExtensionProperties()) {
+        if (std::strcmp(ext.extensionName.data(), VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0) {
+            extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+            m_debugUtils = true;
+        }
+    }
+
+    // 1. Define the required extensions for Wayland (none when rendering offscreen)
+    if (!m_headless) {
+        extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);         // "VK_KHR_surface"
+        extensions.push_back(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME); // "VK_KHR_wayland_surface"
+    }
 
     // 2. Early Messenger (for instance create/destroy validation)
     vk::DebugUtilsMessengerCreateInfoEXT debugInfo{
@@ -111,7 +204,7 @@ vk::raii::Instance Renderer::create_instance() {
     };
     // 2. Set up the Instance creation info
     vk::InstanceCreateInfo createInfo{
-        .pNext = &debugInfo, // Capture instance creation errors
+        .pNext = m_debugUtils ? &debugInfo : nullptr, // Capture instance creation errors
         .pApplicationInfo = &appInfo,
         .enabledLayerCount = static_cast<uint32_t>(layers.size()),
         .ppEnabledLayerNames = layers.data(),
@@ -135,7 +228,7 @@ vk::raii::SurfaceKHR Renderer::create_surface(wl_display* display, wl_surface* s
             .pfnUserCallback = debugCallback
         };
 
-        m_debugMessenger = vk::raii::DebugUtilsMessengerEXT(m_instance, debugInfo);
+        if (m_debugUtils) m_debugMessenger = vk::raii::DebugUtilsMessengerEXT(m_instance, debugInfo);
 
 
     vk::WaylandSurfaceCreateInfoKHR createInfo{
@@ -182,7 +275,7 @@ uint32_t Renderer::find_queue_family() {
 
         // 3. Check for Surface/Presentation support (Wayland)
         // m_surface is the vk::raii::SurfaceKHR you created earlier
-        bool supportsPresent = m_physicalDevice.getSurfaceSupportKHR(i, *m_surface);
+        bool supportsPresent = m_headless || m_physicalDevice.getSurfaceSupportKHR(i, *m_surface);
 
         if (supportsGraphics && supportsPresent) {
             return i;
@@ -192,6 +285,35 @@ uint32_t Renderer::find_queue_family() {
     throw std::runtime_error("Failed to find a suitable queue family!");
 }
 
+void Renderer::find_async_families() {
+    // Dedicated families run beside graphics: DMA engines for streaming, async compute for later passes.
+    // Optional: without them uploads share the graphics queue. ZETA_NO_ASYNC_QUEUES=1 forces that path.
+    m_transferFamily = m_queueFamilyIndex;
+    m_computeFamily = UINT32_MAX;
+    if (std::getenv("ZETA_NO_ASYNC_QUEUES")) return;
+
+    auto queueFamilies = m_physicalDevice.getQueueFamilyProperties();
+    int transferScore = 0;
+    for (uint32_t i = 0; i < queueFamilies.size(); ++i) {
+        auto flags = queueFamilies[i].queueFlags;
+        if (i == m_queueFamilyIndex || (flags & vk::QueueFlagBits::eGraphics)) continue;
+
+        // 1. Async compute: the first non-graphics compute family
+        if ((flags & vk::QueueFlagBits::eCompute) && m_computeFamily == UINT32_MAX) m_computeFamily = i;
+
+        // 2. Transfer: a pure copy engine beats a compute family; both need texel-granular image copies
+        auto granularity = queueFamilies[i].minImageTransferGranularity;
+        bool granular = granularity.width == 1 && granularity.height == 1 && granularity.depth == 1;
+        int score = !granular ? 0 : !(flags & vk::QueueFlagBits::eCompute) ? 2 : 1;
+        if ((flags & (vk::QueueFlagBits::eTransfer | vk::QueueFlagBits::eCompute)) && score > transferScore) {
+            transferScore = score;
+            m_transferFamily = i;
+        }
+    }
+    // Leave compute its own family when transfer could only borrow it
+    if (m_transferFamily == m_computeFamily && queueFamilies[m_computeFamily].queueCount < 2) m_computeFamily = UINT32_MAX;
+}
+
 vk::raii::Device Renderer::create_logical_device() {
     // 1. Setup Features (Vulkan 1.3 style)
     vk::PhysicalDeviceVulkan13Features features13{
@@ -209,21 +331,50 @@ vk::raii::Device Renderer::create_logical_device() {
         .shaderDrawParameters = VK_TRUE // Fixed your SPIR-V error
     };
 
-    // 2. Queue and Extension setup
-    float queuePriority = 1.0f;
-    vk::DeviceQueueCreateInfo queueCreateInfo{
-        .queueFamilyIndex = m_queueFamilyIndex,
-        .queueCount = 1,
-        .pQueuePriorities = &queuePriority
-    };
+    // 2. Queue and Extension setup: graphics, plus the transfer and compute families when separate
+    //    (they share one family only when it has a queue for each)
+    float queuePriorities[2] = { 1.0f, 1.0f };
+    std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
+    for (uint32_t family : { m_queueFamilyIndex, m_transferFamily, m_computeFamily }) {
+        if (family == UINT32_MAX) continue;
+        auto existing = std::find_if(queueCreateInfos.begin(), queueCreateInfos.end(), [&](const auto& q) { return q.queueFamilyIndex == family; });
+        if (existing != queueCreateInfos.end()) {
+            if (family != m_queueFamilyIndex) existing->queueCount = 2;
+            continue;
+        }
+        queueCreateInfos.push_back({ .queueFamilyIndex = family, .queueCount = 1, .pQueuePriorities = queuePriorities });
+    }
+
+    std::vector<const char*> extensions;
+    if (!m_headless) extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+    // Graphics pipeline libraries let the registry link new permutations from shared parts.
+    // Optional: without them it builds monolithic pipelines. ZETA_NO_GPL=1 forces that path.
+    vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gplFeatures{};
+    bool hasGplExtension = false;
+    for (const auto& ext : m_physicalDevice.enumerateDeviceExtensionProperties()) {
+        if (strcmp(ext.extensionName.data(), VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) == 0) hasGplExtension = true;
+        if (strcmp(ext.extensionName.data(), VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) m_memoryBudget = true;
+    }
+    if (hasGplExtension && !std::getenv("ZETA_NO_GPL")) {
+        auto chain = m_physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+        m_graphicsPipelineLibrary = chain.get<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>().graphicsPipelineLibrary;
+    }
+    if (m_graphicsPipelineLibrary) {
+        extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        gplFeatures.graphicsPipelineLibrary = VK_TRUE;
+        features13.pNext = &gplFeatures;
+    }
 
-    std::vector<const char*> extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    // Per-heap budget and usage as the driver sees it; the residency manager counts for itself without
+    if (m_memoryBudget) extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
     // 3. Create Device
     vk::DeviceCreateInfo createInfo{
         .pNext = &features11, // Link the feature chain here!
-        .queueCreateInfoCount = 1,
-        .pQueueCreateInfos = &queueCreateInfo,
+        .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
+        .pQueueCreateInfos = queueCreateInfos.data(),
         .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
         .ppEnabledExtensionNames = extensions.data()
     };
@@ -237,63 +388,83 @@ vk::raii::Queue Renderer::create_graphics_queue() {
     return vk::raii::Queue(m_device, m_queueFamilyIndex, 0);
 }
 
+void Renderer::create_transfer_queue() {
+    // Queue 0 of each separate family; compute takes queue 1 when it shares the transfer family
+    bool separate = m_transferFamily != m_queueFamilyIndex;
+    if (separate) m_transferQueue = vk::raii::Queue(m_device, m_transferFamily, 0);
+    if (m_computeFamily != UINT32_MAX) {
+        m_computeQueue = vk::raii::Queue(m_device, m_computeFamily, m_computeFamily == m_transferFamily ? 1 : 0);
+    }
+
+    m_transfer.init(m_device, m_allocator, separate ? m_transferQueue : m_graphicsQueue, m_transferFamily, m_queueFamilyIndex, m_stagingSize);
+    std::println("transfer queue: {}, async compute: {}",
+        separate ? std::format("family {}", m_transferFamily) : std::string("shared with graphics"),
+        m_computeFamily != UINT32_MAX ? std::format("family {}", m_computeFamily) : std::string("none"));
+    m_streamer.init(m_transfer);
+}
+
 vk::raii::SwapchainKHR Renderer::create_swapchain(uint32_t width, uint32_t height, VkSwapchainKHR oldHandle) {
    
-    // 1. Query basic surface capabilities
+    // 1. Query what the surface actually supports
     auto capabilities = m_physicalDevice.getSurfaceCapabilitiesKHR(*m_surface);
     auto formats = m_physicalDevice.getSurfaceFormatsKHR(*m_surface);
-    
-    // 2. Select format (usually B8G8R8A8_SRGB is a safe bet)
-    vk::SurfaceFormatKHR surfaceFormat = formats[0]; 
-    for (const auto& f : formats) {
-        if (f.format == vk::Format::eA2B10G10R10UnormPack32  && f.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear) { //vk::Format::eB8G8R8A8Srgb
-            surfaceFormat = f;
-            break;
-        }
-    }
+    auto presentModes = m_physicalDevice.getSurfacePresentModesKHR(*m_surface);
+
+    // 2. Let the profile pick present mode, image count and format from that
+    SwapchainChoice choice = choose_swapchain(m_swapchainProfile, capabilities, presentModes, formats);
 
     // 3. Configure the swapchain extent (clamped to surface limits)
     vk::Extent2D extent{
         std::clamp(width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width),
         std::clamp(height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height)
     };
-    std::println("extent: {}, {}", extent.width, extent.height);
-   // extent = capabilities.currentExtent;
-   // std::println("extent: {}, {}", width, height);
-
-    // 4. Set image count (usually triple buffering)
-    uint32_t imageCount = capabilities.minImageCount + 1;
-    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount) {
-        imageCount = capabilities.maxImageCount;
-    }
 
-    m_swapchainFormat = surfaceFormat.format; 
+    // Resizes recreate with the same choice; only log when the outcome actually changes
+    bool changed = m_loggedProfile != m_swapchainProfile || choice.format.format != m_swapchainFormat || choice.presentMode != m_presentMode;
+    m_loggedProfile = m_swapchainProfile;
+    m_swapchainFormat = choice.format.format;
     m_swapchainExtent = extent;
+    m_presentMode = choice.presentMode;
 
-    if (surfaceFormat.format == vk::Format::eA2B10G10R10UnormPack32) {
-        std::println("format correct");
-    } else {
-        std::println("format wrong");
-    }
-    static int count = 0;
-    // 5. Build the Swapchain info
+    // Transfer dst lets the dynamic resolution pass blit into the image (every Wayland driver offers it)
+    vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment;
+    if (capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst) usage |= vk::ImageUsageFlagBits::eTransferDst;
+    // 4. Build the Swapchain info
     vk::SwapchainCreateInfoKHR createInfo{
         .surface = *m_surface,
-        .minImageCount = imageCount,
-        .imageFormat = vk::Format::eA2B10G10R10UnormPack32, //surfaceFormat.format,
-        .imageColorSpace = surfaceFormat.colorSpace,
+        .minImageCount = choice.imageCount,
+        .imageFormat = choice.format.format,
+        .imageColorSpace = choice.format.colorSpace,
         .imageExtent = extent,
         .imageArrayLayers = 1,
-        .imageUsage = vk::ImageUsageFlagBits::eColorAttachment,
+        .imageUsage = usage,
         .imageSharingMode = vk::SharingMode::eExclusive, // Assuming graphics and present queue are the same
         .preTransform = capabilities.currentTransform,
-        .compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque,
-        .presentMode = vk::PresentModeKHR::eMailbox, // Guaranteed to be supported
+        .compositeAlpha = choice.compositeAlpha,
+        .presentMode = choice.presentMode,
         .clipped = VK_TRUE,
         .oldSwapchain = oldHandle
     };
+    vk::raii::SwapchainKHR swapchain(m_device, createInfo);
+
+    // 5. Telemetry: what the policy ended up with (the driver may add images beyond minImageCount)
+    uint32_t actualImages = static_cast<uint32_t>(swapchain.getImages().size());
+    m_swapchainProfileGauge.set(static_cast<double>(m_swapchainProfile));
+    m_swapchainPresentModeGauge.set(static_cast<double>(choice.presentMode));
+    m_swapchainImagesGauge.set(actualImages);
+    if (choice.fallback) m_swapchainFallbacks.add();
+    if (changed) std::println("swapchain: {} profile -> {}, {} images, {} {}x{}{}", profile_name(m_swapchainProfile),
+        vk::to_string(choice.presentMode), actualImages, vk::to_string(choice.format.format),
+        extent.width, extent.height, choice.fallback ? " (fallback)" : "");
+
+    return swapchain;
+}
 
-    return vk::raii::SwapchainKHR(m_device, createInfo);
+void Renderer::set_swapchain_profile(SwapchainProfile profile) {
+    if (profile == m_swapchainProfile) return;
+    m_swapchainProfile = profile;
+    // Rebuilt at the next draw_frame(), through the same path as a resize
+    if (*m_swapchain) handle_resize(m_swapchainExtent.width, m_swapchainExtent.height);
 }
 
 void Renderer::create_sync_objects() {
@@ -310,9 +481,9 @@ void Renderer::create_sync_objects() {
     };
 
     // 3. Populate vectors with RAII objects
-    m_imageAvailableSemaphores.reserve(MAX_FRAMES_IN_FLIGHT);
+    m_imageAvailableSemaphores.reserve(m_framesInFlight);
 
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
         m_imageAvailableSemaphores.emplace_back(m_device, binaryInfo);
     }
 
@@ -326,6 +497,17 @@ void Renderer::create_sync_objects() {
 }
 
 
+void Renderer::create_query_pool() {
+    // 1. Tick period and valid bits come from the device and the queue family we submit on
+    auto properties = m_physicalDevice.getProperties();
+    auto queueFamilies = m_physicalDevice.getQueueFamilyProperties();
+    m_timestamp_period = properties.limits.timestampPeriod;
+    uint32_t validBits = queueFamilies[m_queueFamilyIndex].timestampValidBits;
+
+    // 2. One timestamp pool per frame-in-flight slot, owned by the profiler
+    m_gpuProfiler.init(m_device, m_timestamp_period, validBits, m_framesInFlight);
+}
+
 vk::raii::CommandPool Renderer::create_command_pool() {
     // 1. Create the Command Pool
     vk::CommandPoolCreateInfo poolInfo{
@@ -340,7 +522,7 @@ vk::raii::CommandBuffers Renderer::create_command_buffers() {
     vk::CommandBufferAllocateInfo allocInfo{
         .commandPool = *m_commandPool,
         .level = vk::CommandBufferLevel::ePrimary,
-        .commandBufferCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)
+        .commandBufferCount = m_framesInFlight
     };
 
     // This returns a vk::raii::CommandBuffers object
@@ -348,133 +530,425 @@ vk::raii::CommandBuffers Renderer::create_command_buffers() {
     return vk::raii::CommandBuffers(m_device, allocInfo);
 }
 
-void Renderer::draw_frame() {
+bool Renderer::draw_frame() {
+    ZETA_ZONE("Renderer::draw_frame");
+
     // 1. HANDLE EXTERNAL RESIZE REQUESTS (from Event Bus)
     if (m_resizeRequested) {
-        m_device.waitIdle();
         recreate_swapchain(m_newWidth, m_newHeight);
         m_resizeRequested = false;
     }
 
     // 2. CPU-GPU SYNC: WAIT FOR RESOURCE AVAILABILITY
-    uint32_t syncIndex = m_currentFrameCounter % MAX_FRAMES_IN_FLIGHT;
+    uint32_t syncIndex = m_currentFrameCounter % m_framesInFlight;
     
     // If we have already filled our "in-flight" slots, wait for the oldest one to finish
-    if (m_currentFrameCounter >= MAX_FRAMES_IN_FLIGHT) {
-        uint64_t waitValue = m_currentFrameCounter - MAX_FRAMES_IN_FLIGHT + 1;
+    if (m_currentFrameCounter >= m_framesInFlight) {
+        uint64_t waitValue = m_currentFrameCounter - m_framesInFlight + 1;
         vk::SemaphoreWaitInfo waitInfo{
             .semaphoreCount = 1,
             .pSemaphores = &(*m_frameTimeline),
             .pValues = &waitValue
         };
         // This ensures CommandBuffer[syncIndex] and BinarySemaphores[syncIndex] are safe
+        ZETA_ZONE("wait_frame_slot");
         (void)m_device.waitSemaphores(waitInfo, UINT64_MAX);
     }
 
+    // Free whatever earlier resizes retired now that the GPU has moved past it
+    uint64_t completedValue = m_frameTimeline.getCounterValue();
+    if (m_deletionQueue.size() > 0) {
+        m_deletionQueue.collect(completedValue);
+        m_retiredObjects.set(static_cast<double>(m_deletionQueue.size()));
+    }
+    // Budgets after the collect, which may just have returned memory to the driver
+    m_residency.update(m_currentFrameCounter + 1);
+    // Streamed reads that finished hand over here; copies their callbacks record join this batch
+    m_streamer.update();
+    // Uploads recorded since the last frame start copying now, beside this frame
+    m_transfer.submit();
+
     // 3. ACQUIRE IMAGE (With Internal Resize Handling)
     uint32_t imageIndex;
-    try {
-        // Use syncIndex for the binary "image available" semaphore
-        auto acquireResult = m_swapchain.acquireNextImage(UINT64_MAX, *m_imageAvailableSemaphores[syncIndex]);
-        imageIndex = acquireResult.value;
-    } catch (const vk::OutOfDateKHRError&) {
-        m_resizeRequested = true;
-        return; // Safe to return because we haven't changed the timeline state yet
+    if (m_headless) {
+        // One offscreen target per slot, and the slot wait above already guarantees it is idle
+        imageIndex = syncIndex;
+    } else {
+        try {
+            ZETA_ZONE("acquire");
+            auto acquireStart = std::chrono::steady_clock::now();
+            // Use syncIndex for the binary "image available" semaphore
+            auto acquireResult = m_swapchain.acquireNextImage(UINT64_MAX, *m_imageAvailableSemaphores[syncIndex]);
+            imageIndex = acquireResult.value;
+            m_acquireLatency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - acquireStart).count());
+        } catch (const vk::OutOfDateKHRError&) {
+            m_resizeRequested = true;
+            return false; // Safe to return because we haven't changed the timeline state yet
+        }
     }
 
     // 4. COMMAND RECORDING
     auto& cmd = m_commandBuffers[syncIndex];
-    cmd.reset();
-    cmd.begin({ .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+    uint64_t transferWait = 0; // Uploads this frame acquires (already complete: the wait never stalls)
+    {
+        ZETA_ZONE("record");
+        auto recordStart = std::chrono::steady_clock::now();
+        cmd.reset();
+        m_recorder.begin_frame(syncIndex);
+        cmd.begin({ .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+        m_gpuProfiler.begin_frame(cmd, syncIndex, m_currentFrameCounter + 1, completedValue);
+        transferWait = m_transfer.record_acquires(cmd);
+        // Right after begin_frame, which just resolved the newest GPU timings
+        update_render_scale();
+        m_uploadRing.begin_frame(syncIndex, m_currentFrameCounter + 1, completedValue);
+        write_frame_uniforms();
+
+        record_commands(cmd, imageIndex);
+        if (m_readbackRequested) record_readback(cmd, imageIndex);
+        cmd.end();
+        m_uploadRing.end_frame();
+
+        auto recordTime = std::chrono::steady_clock::now() - recordStart;
+        m_lastRecordMs = std::chrono::duration<float, std::milli>(recordTime).count();
+        m_recordTime.record(std::chrono::duration_cast<std::chrono::microseconds>(recordTime).count());
+    }
+
+    // 5. SUBMIT WORK
+    uint64_t signalValue = m_currentFrameCounter + 1;
+
+    // With dynamic resolution the swapchain image is first touched, and last written, by the blit
+    vk::PipelineStageFlags2 imageStages = dynamic_resolution()
+        ? vk::PipelineStageFlagBits2::eBlit
+        : vk::PipelineStageFlags2(vk::PipelineStageFlagBits2::eColorAttachmentOutput);
+
+    std::array<vk::SemaphoreSubmitInfo, 2> waitSemaphores;
+    uint32_t waitCount = 0;
+    if (!m_headless) {
+        waitSemaphores[waitCount++] = { .semaphore = *m_imageAvailableSemaphores[syncIndex], .stageMask = imageStages };
+    }
+    if (transferWait > 0) {
+        waitSemaphores[waitCount++] = { .semaphore = *m_transfer.timeline(), .value = transferWait, .stageMask = vk::PipelineStageFlagBits2::eAllCommands };
+    }
+
+    std::array<vk::SemaphoreSubmitInfo, 2> signalSemaphores = {{
+        { .semaphore = *m_frameTimeline, .value = signalValue, .stageMask = vk::PipelineStageFlagBits2::eAllCommands },
+        { .semaphore = *m_renderFinishedSemaphores[imageIndex], .stageMask = imageStages }
+    }};
 
+    vk::CommandBufferSubmitInfo cmdInfo{ .commandBuffer = *cmd };
+
+    // Offscreen frames have nothing to acquire or present, only the timeline is signalled
+    {
+        ZETA_ZONE("submit");
+        m_graphicsQueue.submit2(vk::SubmitInfo2{
+            .waitSemaphoreInfoCount = waitCount,
+            .pWaitSemaphoreInfos = waitSemaphores.data(),
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &cmdInfo,
+            .signalSemaphoreInfoCount = m_headless ? 1u : 2u,
+            .pSignalSemaphoreInfos = signalSemaphores.data()
+        });
+    }
+
+    if (m_readbackRequested) {
+        m_readbackRequested = false;
+        m_readbackValue = signalValue;
+    }
+
+    // 6. PRESENT
+    bool presented = false;
+    if (!m_headless) {
+        vk::PresentInfoKHR presentInfo{
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &(*m_renderFinishedSemaphores[imageIndex]),
+            .swapchainCount = 1,
+            .pSwapchains = &(*m_swapchain),
+            .pImageIndices = &imageIndex
+        };
+
+        try {
+            ZETA_ZONE("present");
+            auto presentStart = std::chrono::steady_clock::now();
+            (void)m_graphicsQueue.presentKHR(presentInfo);
+            presented = true;
+            m_presentLatency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - presentStart).count());
+        } catch (const vk::OutOfDateKHRError&) {
+            m_resizeRequested = true;
+        }
+    }
+
+    // Only increment once we are sure the GPU has a signal to process
+    m_currentFrameCounter++;
+    return presented;
+}
+
+
+void Renderer::record_draws(const vk::raii::CommandBuffer& cmd, uint32_t first, uint32_t count) {
+    // A pipeline still compiling is skipped, never waited on
+    vk::Pipeline pipeline = m_trianglePipeline.pipeline();
+    if (!pipeline || count == 0) return;
+
+    // Secondaries inherit no state, so every recording binds and sets its own
+    cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *m_pipelineLayout, 0, *m_frameSet, m_frameUniformOffset);
+    // The scaled render area when dynamic resolution is on, the whole image otherwise
+    vk::Extent2D area = dynamic_resolution() ? m_renderExtent : m_swapchainExtent;
+    cmd.setViewport(0, vk::Viewport{0.0f, 0.0f, (float)area.width, (float)area.height, 0.0f, 1.0f});
+    cmd.setScissor(0, vk::Rect2D{{0, 0}, area});
+    for (uint32_t i = first; i < first + count; ++i) {
+        cmd.draw(3, 1, 0, 0);
+    }
+}
+
+void Renderer::record_commands(const vk::raii::CommandBuffer& cmd, uint32_t imageIndex) {
+    auto frameScope = m_gpuProfiler.scope(cmd, "frame");
     vk::Image image = m_swapchainImages[imageIndex];
+    // Dynamic resolution draws into the scene target and blits; otherwise straight into the image
+    bool scaled = dynamic_resolution();
+    vk::Image target = scaled ? *m_sceneImage : image;
+    vk::Extent2D area = scaled ? m_renderExtent : m_swapchainExtent;
 
-    // Transition Undefined -> Attachment
+    // Transition Undefined -> Attachment (the scene target's previous contents were last read by a blit)
     vk::ImageMemoryBarrier2 barrier_to_render{
+        .srcStageMask = scaled ? vk::PipelineStageFlagBits2::eBlit : vk::PipelineStageFlagBits2::eNone,
         .dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
         .dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
         .oldLayout = vk::ImageLayout::eUndefined,
         .newLayout = vk::ImageLayout::eColorAttachmentOptimal,
-        .image = image,
+        .image = target,
         .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
     };
     cmd.pipelineBarrier2({ .imageMemoryBarrierCount = 1, .pImageMemoryBarriers = &barrier_to_render });
 
     // Begin Rendering
     vk::RenderingAttachmentInfo colorAttachment{
-        .imageView = *m_swapchainImageViews[imageIndex],
+        .imageView = scaled ? *m_sceneView : *m_swapchainImageViews[imageIndex],
         .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
         .loadOp = vk::AttachmentLoadOp::eClear,
         .storeOp = vk::AttachmentStoreOp::eStore,
         .clearValue = vk::ClearColorValue(std::array<float, 4>{1.0f, 0.5f, 0.0f, 1.0f})
     };
 
-    cmd.beginRendering({
-        .renderArea = { {0, 0}, m_swapchainExtent },
-        .layerCount = 1,
-        .colorAttachmentCount = 1,
-        .pColorAttachments = &colorAttachment
-    });
+    {
+        auto passScope = m_gpuProfiler.scope(cmd, "main_pass");
+        bool parallel = m_recorder.enabled();
+        cmd.beginRendering({
+            .flags = parallel ? vk::RenderingFlags(vk::RenderingFlagBits::eContentsSecondaryCommandBuffers) : vk::RenderingFlags{},
+            .renderArea = { {0, 0}, area },
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &colorAttachment
+        });
+
+        if (parallel) {
+            // A few chunks per thread lets fast threads pick up slack; order is fixed by chunk index
+            uint32_t chunks = std::min(m_drawCount, m_recorder.thread_count() * 4);
+            vk::CommandBufferInheritanceRenderingInfo inheritance{
+                .colorAttachmentCount = 1,
+                .pColorAttachmentFormats = &m_swapchainFormat,
+                .rasterizationSamples = vk::SampleCountFlagBits::e1
+            };
+            auto secondaries = m_recorder.record(chunks, inheritance, [&](const vk::raii::CommandBuffer& secondary, uint32_t chunk) {
+                uint32_t first = static_cast<uint32_t>(uint64_t{m_drawCount} * chunk / chunks);
+                uint32_t last = static_cast<uint32_t>(uint64_t{m_drawCount} * (chunk + 1) / chunks);
+                record_draws(secondary, first, last - first);
+            });
+            if (!secondaries.empty()) cmd.executeCommands(vk::ArrayProxy<const vk::CommandBuffer>(static_cast<uint32_t>(secondaries.size()), secondaries.data()));
+        } else {
+            record_draws(cmd, 0, m_drawCount);
+        }
 
-    // Draw calls
-    cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_graphicsPipeline);
-    cmd.setViewport(0, vk::Viewport{0.0f, 0.0f, (float)m_swapchainExtent.width, (float)m_swapchainExtent.height, 0.0f, 1.0f});
-    cmd.setScissor(0, vk::Rect2D{{0, 0}, m_swapchainExtent});
-    cmd.draw(3, 1, 0, 0);
+        cmd.endRendering();
+    }
 
-    cmd.endRendering();
+    // Last writer of the swapchain image, for the final transition below
+    vk::PipelineStageFlags2 lastStage = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+    vk::AccessFlags2 lastAccess = vk::AccessFlagBits2::eColorAttachmentWrite;
+    vk::ImageLayout lastLayout = vk::ImageLayout::eColorAttachmentOptimal;
+
+    if (scaled) {
+        auto upscaleScope = m_gpuProfiler.scope(cmd, "upscale");
+
+        // Scene target Attachment -> TransferSrc, swapchain image Undefined -> TransferDst
+        std::array<vk::ImageMemoryBarrier2, 2> toBlit{{
+            {
+                .srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+                .srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+                .dstStageMask = vk::PipelineStageFlagBits2::eBlit,
+                .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+                .oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+                .newLayout = vk::ImageLayout::eTransferSrcOptimal,
+                .image = target,
+                .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
+            },
+            {
+                .srcStageMask = vk::PipelineStageFlagBits2::eBlit, // Chains with the acquire wait
+                .dstStageMask = vk::PipelineStageFlagBits2::eBlit,
+                .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+                .oldLayout = vk::ImageLayout::eUndefined,
+                .newLayout = vk::ImageLayout::eTransferDstOptimal,
+                .image = image,
+                .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
+            }
+        }};
+        cmd.pipelineBarrier2({ .imageMemoryBarrierCount = 2, .pImageMemoryBarriers = toBlit.data() });
+
+        // Linear filtering does the upscale
+        vk::ImageBlit2 region{
+            .srcSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+            .srcOffsets = std::array<vk::Offset3D, 2>{{ {0, 0, 0}, {(int32_t)area.width, (int32_t)area.height, 1} }},
+            .dstSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+            .dstOffsets = std::array<vk::Offset3D, 2>{{ {0, 0, 0}, {(int32_t)m_swapchainExtent.width, (int32_t)m_swapchainExtent.height, 1} }}
+        };
+        cmd.blitImage2({
+            .srcImage = target,
+            .srcImageLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .dstImage = image,
+            .dstImageLayout = vk::ImageLayout::eTransferDstOptimal,
+            .regionCount = 1,
+            .pRegions = &region,
+            .filter = vk::Filter::eLinear
+        });
+
+        lastStage = vk::PipelineStageFlagBits2::eBlit;
+        lastAccess = vk::AccessFlagBits2::eTransferWrite;
+        lastLayout = vk::ImageLayout::eTransferDstOptimal;
+    }
 
-    // Transition Attachment -> Present
-    vk::ImageMemoryBarrier2 barrier_to_present = barrier_to_render;
-    barrier_to_present.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
-    barrier_to_present.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite;
-    barrier_to_present.oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
-    barrier_to_present.newLayout = vk::ImageLayout::ePresentSrcKHR;
+    // Transition -> Present (or -> TransferSrc for offscreen targets, ready for readback)
+    vk::ImageMemoryBarrier2 barrier_to_present{
+        .srcStageMask = lastStage,
+        .srcAccessMask = lastAccess,
+        .dstStageMask = lastStage, // Same scope as the render-finished signal
+        .oldLayout = lastLayout,
+        .newLayout = vk::ImageLayout::ePresentSrcKHR,
+        .image = image,
+        .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
+    };
+    if (m_headless) {
+        barrier_to_present.dstStageMask = vk::PipelineStageFlagBits2::eCopy;
+        barrier_to_present.dstAccessMask = vk::AccessFlagBits2::eTransferRead;
+        barrier_to_present.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    }
     cmd.pipelineBarrier2({ .imageMemoryBarrierCount = 1, .pImageMemoryBarriers = &barrier_to_present });
+}
 
-    cmd.end();
+void Renderer::record_readback(const vk::raii::CommandBuffer& cmd, uint32_t imageIndex) {
+    // Tightly packed copy of the final image into the host-visible readback buffer
+    vk::BufferImageCopy region{
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+        .imageOffset = { 0, 0, 0 },
+        .imageExtent = { m_swapchainExtent.width, m_swapchainExtent.height, 1 }
+    };
+    cmd.copyImageToBuffer(m_swapchainImages[imageIndex], vk::ImageLayout::eTransferSrcOptimal, *m_readbackBuffer, region);
+
+    // Make the copy visible to the host once the timeline says the frame is done
+    vk::MemoryBarrier2 toHost{
+        .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+        .dstAccessMask = vk::AccessFlagBits2::eHostRead
+    };
+    cmd.pipelineBarrier2({ .memoryBarrierCount = 1, .pMemoryBarriers = &toHost });
+}
 
-    // 5. SUBMIT WORK
-    uint64_t signalValue = m_currentFrameCounter + 1;
+void Renderer::request_readback() {
+    if (!m_headless) {
+        std::println("readback is only available in headless mode");
+        return;
+    }
+    m_readbackRequested = true;
+}
+
+Task<std::vector<uint8_t>> Renderer::readback_async() {
+    if (!m_headless) {
+        request_readback(); // Logs why it is unavailable
+        co_return std::vector<uint8_t>{};
+    }
 
-    vk::SemaphoreSubmitInfo waitSemaphore{
-        .semaphore = *m_imageAvailableSemaphores[syncIndex],
-        .stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput
+    // The copy rides in the next submitted frame, which signals the next timeline value
+    uint64_t value = m_currentFrameCounter + 1;
+    request_readback();
+    co_await TaskScheduler::get().wait_timeline(m_frameTimeline, value);
+    co_return take_readback(); // Already signalled: no wait inside
+}
+
+std::vector<uint8_t> Renderer::take_readback() {
+    if (m_readbackValue == 0) return {};
+
+    // 1. Wait for the frame that recorded the copy (golden-image tests can afford this stall)
+    vk::SemaphoreWaitInfo waitInfo{
+        .semaphoreCount = 1,
+        .pSemaphores = &(*m_frameTimeline),
+        .pValues = &m_readbackValue
     };
+    (void)m_device.waitSemaphores(waitInfo, UINT64_MAX);
+    m_readbackValue = 0;
+
+    // 2. Copy out of the persistent mapping (host-cached memory needs an invalidate first)
+    vk::DeviceSize size = static_cast<vk::DeviceSize>(m_swapchainExtent.width) * m_swapchainExtent.height * 4;
+    std::vector<uint8_t> pixels(size);
+    m_allocator.invalidate(m_readbackMemory, 0, size);
+    std::memcpy(pixels.data(), m_readbackMemory.mapped(), size);
+    return pixels;
+}
 
-    std::array<vk::SemaphoreSubmitInfo, 2> signalSemaphores = {{
-        { .semaphore = *m_renderFinishedSemaphores[imageIndex], .stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput },
-        { .semaphore = *m_frameTimeline, .value = signalValue, .stageMask = vk::PipelineStageFlagBits2::eAllCommands }
-    }};
+void Renderer::create_offscreen_targets(uint32_t width, uint32_t height) {
+    // 8-bit RGBA keeps readback tightly packed and is renderable everywhere, lavapipe included
+    m_swapchainFormat = vk::Format::eR8G8B8A8Unorm;
+    m_swapchainExtent = vk::Extent2D{ width, height };
 
-    vk::CommandBufferSubmitInfo cmdInfo{ .commandBuffer = *cmd };
+    m_offscreenImages.clear();
+    m_offscreenMemory.clear();
+    m_swapchainImages.clear();
 
-    m_graphicsQueue.submit2(vk::SubmitInfo2{
-        .waitSemaphoreInfoCount = 1,
-        .pWaitSemaphoreInfos = &waitSemaphore,
-        .commandBufferInfoCount = 1,
-        .pCommandBufferInfos = &cmdInfo,
-        .signalSemaphoreInfoCount = 2,
-        .pSignalSemaphoreInfos = signalSemaphores.data()
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+        vk::ImageCreateInfo imageInfo{
+            .imageType = vk::ImageType::e2D,
+            .format = m_swapchainFormat,
+            .extent = { width, height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined
+        };
+        vk::raii::Image image(m_device, imageInfo);
+        GpuAllocation memory = m_allocator.bind(image, MemoryUsage::GpuOnly);
+
+        m_swapchainImages.push_back(*image);
+        m_offscreenImages.push_back(std::move(image));
+        m_offscreenMemory.push_back(std::move(memory));
+    }
+
+    // Host-visible buffer the readback copy lands in
+    vk::DeviceSize size = static_cast<vk::DeviceSize>(width) * height * 4;
+    m_readbackBuffer = vk::raii::Buffer(m_device, vk::BufferCreateInfo{
+        .size = size,
+        .usage = vk::BufferUsageFlagBits::eTransferDst,
+        .sharingMode = vk::SharingMode::eExclusive
     });
+    m_readbackMemory = m_allocator.bind(m_readbackBuffer, MemoryUsage::Readback);
+}
 
-    // 6. PRESENT
-    vk::PresentInfoKHR presentInfo{
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &(*m_renderFinishedSemaphores[imageIndex]),
-        .swapchainCount = 1,
-        .pSwapchains = &(*m_swapchain),
-        .pImageIndices = &imageIndex
-    };
+void Renderer::create_swapchain_image_views() {
+    m_swapchainImageViews.clear();
+    m_swapchainImageViews.reserve(m_swapchainImages.size());
 
-    try {
-        (void)m_graphicsQueue.presentKHR(presentInfo);
-    } catch (const vk::OutOfDateKHRError&) {
-        m_resizeRequested = true;
+    for (auto image : m_swapchainImages) {
+        vk::ImageViewCreateInfo viewInfo{
+            .image = image,
+            .viewType = vk::ImageViewType::e2D,
+            .format = m_swapchainFormat,
+            .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
+        };
+        m_swapchainImageViews.emplace_back(m_device, viewInfo);
     }
-
-    // Only increment once we are sure the GPU has a signal to process
-    m_currentFrameCounter++;
 }
 
 
@@ -482,48 +956,77 @@ void Renderer::recreate_swapchain(uint32_t width, uint32_t height) {
     // 1. Guard against minimized windows (Wayland often sends 0,0)
     if (width == 0 || height == 0) return;
 
-    // 2. Wait for GPU to finish all pending work
-    // This is the "Nuclear Option" but the only safe way during a resize
-    m_device.waitIdle();
+    ZETA_ZONE("Renderer::recreate_swapchain");
+    auto start = std::chrono::steady_clock::now();
 
-    // 3. Clear resources that depend on the old swapchain images
+    // 2. Retire instead of waiting for the GPU
+    // In-flight frames may still render to the old images. Everything tied to the old swapchain is
+    // keyed on the timeline value of the first frame submitted after this point, which covers every
+    // command buffer that used it. Presents are not tracked by the timeline; the spec gives no such
+    // ordering guarantee for them (that would take VK_EXT_swapchain_maintenance1 present fences).
+    uint64_t retireValue = m_currentFrameCounter + 1;
+
+    // 3. Retire resources that depend on the old swapchain images (views before their swapchain)
+    for (auto& view : m_swapchainImageViews) {
+        m_deletionQueue.retire(retireValue, std::move(view));
+    }
     m_swapchainImageViews.clear();
 
-    // 4. Create the new swapchain
-    // We pass the old handle to the factory function to help the driver transition
-    vk::raii::SwapchainKHR oldSwapchain = std::move(m_swapchain);
-    m_swapchain = create_swapchain(width, height, *oldSwapchain);
+    if (m_headless) {
+        // 4. Offscreen: retire the old targets and readback buffer, allocate new ones
+        for (auto& image : m_offscreenImages) m_deletionQueue.retire(retireValue, std::move(image));
+        for (auto& memory : m_offscreenMemory) m_deletionQueue.retire(retireValue, std::move(memory));
+        m_deletionQueue.retire(retireValue, std::move(m_readbackBuffer));
+        m_deletionQueue.retire(retireValue, std::move(m_readbackMemory));
+        m_readbackValue = 0;
+        create_offscreen_targets(width, height);
+    } else {
+        // 4. Create the new swapchain
+        // We pass the old handle to the factory function to help the driver transition
+        vk::Format oldFormat = m_swapchainFormat;
+        vk::raii::SwapchainKHR oldSwapchain = std::move(m_swapchain);
+        m_swapchain = create_swapchain(width, height, *oldSwapchain);
+        m_deletionQueue.retire(retireValue, std::move(oldSwapchain));
+
+        // A profile switch can change the format, and with it the pipeline's attachment format.
+        // The new one compiles on the registry's workers; record_draws skips it until it is ready.
+        if (m_swapchainFormat != oldFormat && m_trianglePipeline.valid()) {
+            m_trianglePipeline = m_pipelines.request(triangle_pipeline_desc());
+        }
 
-    // 5. Retrieve the new image handles
-    m_swapchainImages = m_swapchain.getImages();
+        // 5. Retrieve the new image handles
+        m_swapchainImages = m_swapchain.getImages();
+    }
 
     // 6. Create new Image Views
-    for (auto image : m_swapchainImages) {
-        vk::ImageViewCreateInfo viewInfo{
-            .image = image,
-            .viewType = vk::ImageViewType::e2D,
-            .format = m_swapchainFormat,
-            .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
-        };
-        m_swapchainImageViews.emplace_back(m_device, viewInfo);
+    create_swapchain_image_views();
+    if (dynamic_resolution()) {
+        retire_scene_target(retireValue);
+        create_scene_target();
     }
 
     // 7. RECREATE SYNC OBJECTS
     // This is critical! If the swapchain image count changed (e.g. from 2 to 3),
     // we need a renderFinishedSemaphore for every image index.
-    refresh_sync_objects();
+    refresh_sync_objects(retireValue);
+    m_swapchainRecreations.add();
+
+    // Metrics rather than a log line: interactive resizes recreate at configure rate
+    m_swapchainRecreateTime.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    m_retiredObjects.set(static_cast<double>(m_deletionQueue.size()));
 }
 
-void Renderer::refresh_sync_objects() {
-    // Binary semaphores for Acquire (indexed by syncIndex)
-    // We keep these at MAX_FRAMES_IN_FLIGHT
-    m_imageAvailableSemaphores.clear();
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        m_imageAvailableSemaphores.emplace_back(m_device, vk::SemaphoreCreateInfo{});
-    }
+void Renderer::refresh_sync_objects(uint64_t retireValue) {
+    // Binary semaphores for Acquire (indexed by syncIndex) are untouched: they are only ever
+    // signalled by a successful acquire that is always followed by a submit consuming them,
+    // and the frame timeline wait already guarantees each slot's previous wait finished.
 
     // Binary semaphores for Present (indexed by imageIndex)
-    // We must have one for every physical swapchain image
+    // We must have one for every physical swapchain image. The old ones may still be
+    // waited on by queued presents, so they go through the deletion queue as well.
+    for (auto& semaphore : m_renderFinishedSemaphores) {
+        m_deletionQueue.retire(retireValue, std::move(semaphore));
+    }
     m_renderFinishedSemaphores.clear();
     for (uint32_t i = 0; i < m_swapchainImages.size(); ++i) {
         m_renderFinishedSemaphores.emplace_back(m_device, vk::SemaphoreCreateInfo{});
@@ -536,83 +1039,163 @@ void Renderer::refresh_sync_objects() {
 
 
 
-void Renderer::create_graphics_pipeline() {
-    // 1. Create Shader Modules
-    auto vertCode = load_spirv("shaders/triangle.vert.spv");
-    auto fragCode = load_spirv("shaders/triangle.frag.spv");
+void Renderer::create_frame_resources() {
+    // 1. One upload region per frame-in-flight slot, guarded by the frame timeline
+    m_uploadRing.init(m_device, m_physicalDevice, m_allocator, m_frameTimeline, m_framesInFlight, m_uploadRingSize);
+    m_startTime = std::chrono::steady_clock::now();
 
-    vk::raii::ShaderModule vertModule(m_device, vk::ShaderModuleCreateInfo{
-        .codeSize = vertCode.size() * sizeof(uint32_t),
-        .pCode = vertCode.data()
+    // 2. A single dynamic uniform buffer descriptor covers every region: only the offset moves
+    vk::DescriptorSetLayoutBinding binding{
+        .binding = 0,
+        .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+        .descriptorCount = 1,
+        .stageFlags = vk::ShaderStageFlagBits::eAllGraphics
+    };
+    m_frameSetLayout = vk::raii::DescriptorSetLayout(m_device, vk::DescriptorSetLayoutCreateInfo{
+        .bindingCount = 1,
+        .pBindings = &binding
     });
 
-    vk::raii::ShaderModule fragModule(m_device, vk::ShaderModuleCreateInfo{
-        .codeSize = fragCode.size() * sizeof(uint32_t),
-        .pCode = fragCode.data()
+    // FreeDescriptorSet: the RAII set frees itself
+    vk::DescriptorPoolSize poolSize{ .type = vk::DescriptorType::eUniformBufferDynamic, .descriptorCount = 1 };
+    m_descriptorPool = vk::raii::DescriptorPool(m_device, vk::DescriptorPoolCreateInfo{
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes = &poolSize
     });
+    vk::raii::DescriptorSets sets(m_device, vk::DescriptorSetAllocateInfo{
+        .descriptorPool = *m_descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &(*m_frameSetLayout)
+    });
+    m_frameSet = std::move(sets.front());
+
+    vk::DescriptorBufferInfo bufferInfo{ .buffer = m_uploadRing.buffer(), .offset = 0, .range = sizeof(FrameUniforms) };
+    m_device.updateDescriptorSets(vk::WriteDescriptorSet{
+        .dstSet = *m_frameSet,
+        .dstBinding = 0,
+        .descriptorCount = 1,
+        .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+        .pBufferInfo = &bufferInfo
+    }, {});
+}
 
-    // 2. Define Shader Stages
-    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {{
-        { .stage = vk::ShaderStageFlagBits::eVertex, .module = *vertModule, .pName = "main" },
-        { .stage = vk::ShaderStageFlagBits::eFragment, .module = *fragModule, .pName = "main" }
-    }};
-
-    // 3. Fixed Function States (Minimum for Triangle)
-    vk::PipelineVertexInputStateCreateInfo vertexInput{};
-    vk::PipelineInputAssemblyStateCreateInfo inputAssembly{ .topology = vk::PrimitiveTopology::eTriangleList };
-    
-    // Use dynamic viewport/scissor to avoid recreating pipeline on resize
-    std::array<vk::DynamicState, 2> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
-    vk::PipelineDynamicStateCreateInfo dynamicState{
-        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
-        .pDynamicStates = dynamicStates.data()
+void Renderer::write_frame_uniforms() {
+    vk::Extent2D area = dynamic_resolution() ? m_renderExtent : m_swapchainExtent;
+    FrameUniforms uniforms{
+        .time = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_startTime).count(),
+        .frame = static_cast<uint32_t>(m_currentFrameCounter + 1),
+        .renderScale = dynamic_resolution() ? m_drs.scale() : 1.0f,
+        .extent = { static_cast<float>(area.width), static_cast<float>(area.height) },
+        .invExtent = { area.width ? 1.0f / area.width : 0.0f, area.height ? 1.0f / area.height : 0.0f }
     };
-    vk::PipelineViewportStateCreateInfo viewportState{ .viewportCount = 1, .scissorCount = 1 };
+    // On overrun the draws read the start of the buffer: stale values, never a fault
+    UploadRing::Slice slice = m_uploadRing.push_uniform(uniforms);
+    m_frameUniformOffset = slice ? static_cast<uint32_t>(slice.offset) : 0;
+}
 
-    vk::PipelineRasterizationStateCreateInfo rasterizer{
-        .cullMode = vk::CullModeFlagBits::eBack,
-        .frontFace = vk::FrontFace::eClockwise,
-        .lineWidth = 1.0f
+GraphicsPipelineDesc Renderer::triangle_pipeline_desc() const {
+    // Fixed-function defaults match the triangle (no depth, no blend)
+    return GraphicsPipelineDesc{
+        .vertexShader = "shaders/triangle.vert.spv",
+        .fragmentShader = "shaders/triangle.frag.spv",
+        .layout = *m_pipelineLayout,
+        .colorFormat = m_swapchainFormat
     };
+}
 
-    vk::PipelineMultisampleStateCreateInfo multisampling{ .rasterizationSamples = vk::SampleCountFlagBits::e1 };
+void Renderer::create_graphics_pipeline() {
+    auto start = std::chrono::steady_clock::now();
 
-    vk::PipelineColorBlendAttachmentState colorBlendAttachment{
-        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | 
-                          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
-    };
-    vk::PipelineColorBlendStateCreateInfo colorBlending{
-        .attachmentCount = 1, .pAttachments = &colorBlendAttachment
-    };
+    // 1. Create Pipeline Layout (set 0: per-frame uniforms)
+    m_pipelineLayout = vk::raii::PipelineLayout(m_device, vk::PipelineLayoutCreateInfo{
+        .setLayoutCount = 1,
+        .pSetLayouts = &(*m_frameSetLayout)
+    });
+
+    // 2. Compile on the registry's workers. The first frame needs it, so startup waits;
+    //    pipelines requested later are skipped by record_commands until they are ready.
+    m_trianglePipeline = m_pipelines.request(triangle_pipeline_desc());
+    if (!m_pipelines.wait(m_trianglePipeline)) throw std::runtime_error("failed to create graphics pipeline");
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_pipelineCreateMs.set(ms);
+    std::println("graphics pipeline created in {:.3f} ms ({} cache)", ms, m_pipelineCache.warm() ? "warm" : "cold");
+}
 
-    // 4. Create Pipeline Layout
-    m_pipelineLayout = vk::raii::PipelineLayout(m_device, vk::PipelineLayoutCreateInfo{});
 
-    vk::PipelineRenderingCreateInfo renderingInfo{
-        .colorAttachmentCount = 1,
-        .pColorAttachmentFormats = &m_swapchainFormat // e.g., vk::Format::eB8G8R8A8Srgb
-    };
-    // 5. Create Graphics Pipeline
-    vk::GraphicsPipelineCreateInfo pipelineInfo{
-        .pNext = &renderingInfo, // Attach format info here
-        .stageCount = 2,
-        .pStages = shaderStages.data(),
-        .pVertexInputState = &vertexInput,
-        .pInputAssemblyState = &inputAssembly,
-        .pViewportState = &viewportState,
-        .pRasterizationState = &rasterizer,
-        .pMultisampleState = &multisampling,
-        .pColorBlendState = &colorBlending,
-        .pDynamicState = &dynamicState,
-        .layout = *m_pipelineLayout,
-        .renderPass = nullptr // Note: Use VK_KHR_dynamic_rendering if no RenderPass
-    };
 
-    m_graphicsPipeline = vk::raii::Pipeline(m_device, nullptr, pipelineInfo);
+
+void Renderer::set_dynamic_resolution(double targetMs, float minScale, float maxScale) {
+    m_drs.configure({ .targetMs = targetMs, .minScale = minScale, .maxScale = maxScale });
+    if (!*m_device) return; // init() creates the target
+
+    // Frames in flight may still be drawing into or blitting from the current target
+    uint64_t retireValue = m_currentFrameCounter + 1;
+    if (dynamic_resolution()) retire_scene_target(retireValue);
+    if (m_drs.enabled()) create_scene_target();
 }
 
+void Renderer::create_scene_target() {
+    // 1. The blit needs the format to be a blit source/destination with linear filtering
+    auto features = m_physicalDevice.getFormatProperties(m_swapchainFormat).optimalTilingFeatures;
+    auto needed = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+    if ((features & needed) != needed) {
+        std::println("dynamic resolution: {} cannot be blitted with linear filtering, disabled", vk::to_string(m_swapchainFormat));
+        m_drs.configure({});
+        return;
+    }
+    if (!m_headless && !(m_physicalDevice.getSurfaceCapabilitiesKHR(*m_surface).supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst)) {
+        std::println("dynamic resolution: swapchain images cannot be blit destinations, disabled");
+        m_drs.configure({});
+        return;
+    }
 
+    // 2. Allocated at the full swapchain size once; scaling only shrinks the render area
+    m_sceneImage = vk::raii::Image(m_device, vk::ImageCreateInfo{
+        .imageType = vk::ImageType::e2D,
+        .format = m_swapchainFormat,
+        .extent = { m_swapchainExtent.width, m_swapchainExtent.height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = vk::SampleCountFlagBits::e1,
+        .tiling = vk::ImageTiling::eOptimal,
+        .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .initialLayout = vk::ImageLayout::eUndefined
+    });
+    m_sceneMemory = m_allocator.bind(m_sceneImage, MemoryUsage::GpuOnly);
+    m_sceneView = vk::raii::ImageView(m_device, vk::ImageViewCreateInfo{
+        .image = *m_sceneImage,
+        .viewType = vk::ImageViewType::e2D,
+        .format = m_swapchainFormat,
+        .subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }
+    });
+    update_render_scale();
+}
+
+void Renderer::retire_scene_target(uint64_t retireValue) {
+    // View before the image it was created from
+    m_deletionQueue.retire(retireValue, std::move(m_sceneView));
+    m_deletionQueue.retire(retireValue, std::move(m_sceneImage));
+    m_deletionQueue.retire(retireValue, std::move(m_sceneMemory));
+    m_sceneView = nullptr;
+    m_sceneImage = nullptr;
+    m_sceneMemory = nullptr;
+}
 
+void Renderer::update_render_scale() {
+    if (!dynamic_resolution()) return;
+
+    // The profiler resolves frames a few behind; the controller ignores ones it has already seen
+    const auto& timing = m_gpuProfiler.latest();
+    float scale = timing.frame > 0 ? m_drs.update(timing.frame, timing.totalMs) : m_drs.scale();
+    m_renderExtent = vk::Extent2D{
+        std::clamp(static_cast<uint32_t>(std::lround(m_swapchainExtent.width * scale)), 1u, m_swapchainExtent.width),
+        std::clamp(static_cast<uint32_t>(std::lround(m_swapchainExtent.height * scale)), 1u, m_swapchainExtent.height)
+    };
+}
 
 void Renderer::handle_resize(uint32_t width, uint32_t height) {
     m_resizeRequested = true;
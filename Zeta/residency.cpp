@@ -0,0 +1,171 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/residency.hpp"
+#include "Zeta/profiler.hpp"
+#include <algorithm>
+#include <format>
+#include <print>
+
+namespace Zeta {
+
+namespace {
+
+constexpr double MIB = 1024.0 * 1024.0;
+// Without the extension the driver's own reservations and other processes are invisible
+constexpr double FALLBACK_BUDGET = 0.8;
+
+}
+
+void ResidencyManager::init(const vk::raii::PhysicalDevice& physicalDevice, const GpuAllocator& allocator, bool memoryBudget,
+                            const Settings& settings) {
+    m_physicalDevice = &physicalDevice;
+    m_allocator = &allocator;
+    m_memoryBudget = memoryBudget;
+    m_settings = settings;
+
+    const auto& properties = allocator.memory_properties();
+    m_heaps.resize(properties.memoryHeapCount);
+    for (uint32_t i = 0; i < properties.memoryHeapCount; ++i) {
+        Heap& heap = m_heaps[i];
+        heap.size = properties.memoryHeaps[i].size;
+        heap.status.deviceLocal = static_cast<bool>(properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+        heap.usageGauge = &Metrics::get().gauge(std::format("gpu_heap{}_usage_bytes", i));
+        heap.budgetGauge = &Metrics::get().gauge(std::format("gpu_heap{}_budget_bytes", i));
+    }
+    refresh_budgets();
+    std::println("memory budget: {} heap(s), {}", m_heaps.size(), m_memoryBudget ? "VK_EXT_memory_budget" : "own accounting");
+}
+
+ResidencyManager::ResourceId ResidencyManager::add(uint32_t heap, vk::DeviceSize size, std::function<void()> evict) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (heap >= m_heaps.size()) return 0;
+    ResourceId id = m_nextId++;
+    auto& lru = m_heaps[heap].lru;
+    lru.push_front({ id, size, m_frame, std::move(evict) });
+    m_lookup.emplace(id, std::make_pair(heap, lru.begin()));
+    m_resources.set(static_cast<double>(m_lookup.size()));
+    return id;
+}
+
+ResidencyManager::ResourceId ResidencyManager::add(const GpuAllocation& allocation, std::function<void()> evict) {
+    if (!allocation) return 0;
+    return add(m_allocator->heap_of(allocation.memory_type()), allocation.size(), std::move(evict));
+}
+
+void ResidencyManager::touch(ResourceId id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lookup.find(id);
+    if (it == m_lookup.end()) return;
+    auto& [heap, entry] = it->second;
+    entry->lastUsed = m_frame;
+    auto& lru = m_heaps[heap].lru;
+    lru.splice(lru.begin(), lru, entry);
+}
+
+void ResidencyManager::remove(ResourceId id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lookup.find(id);
+    if (it == m_lookup.end()) return;
+    m_heaps[it->second.first].lru.erase(it->second.second);
+    m_lookup.erase(it);
+    m_resources.set(static_cast<double>(m_lookup.size()));
+}
+
+bool ResidencyManager::resident(ResourceId id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lookup.contains(id);
+}
+
+void ResidencyManager::refresh_budgets() {
+    // Usage counts our sub-allocated bytes rather than our blocks: an eviction frees a range inside
+    // a block that usually stays allocated, and free space in our blocks is what new resources fill
+    // first. The driver's figure still contributes what it sees beyond our blocks (other processes,
+    // driver-internal memory).
+    vk::PhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    if (m_memoryBudget) {
+        auto chain = m_physicalDevice->getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+        budget = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    }
+    for (uint32_t i = 0; i < m_heaps.size(); ++i) {
+        Heap& heap = m_heaps[i];
+        heap.stats = m_allocator->heap_stats(i);
+        if (m_memoryBudget) {
+            vk::DeviceSize external = budget.heapUsage[i] - std::min(budget.heapUsage[i], heap.stats.reserved);
+            heap.status.budget = budget.heapBudget[i];
+            heap.status.usage = external + heap.stats.used;
+        } else {
+            heap.status.budget = static_cast<vk::DeviceSize>(static_cast<double>(heap.size) * FALLBACK_BUDGET);
+            heap.status.usage = heap.stats.used;
+        }
+    }
+    for (const Heap& heap : m_heaps) {
+        heap.usageGauge->set(static_cast<double>(heap.status.usage));
+        heap.budgetGauge->set(static_cast<double>(heap.status.budget));
+    }
+}
+
+void ResidencyManager::update(uint64_t frame) {
+    ZETA_ZONE("ResidencyManager::update");
+    std::vector<std::function<void()>> victims;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frame = frame;
+        refresh_budgets();
+
+        // 1. An eviction stays discounted until the allocator has freed that many bytes on its heap
+        //    since, i.e. until the deletion queue has actually released it and usage shows it
+        std::erase_if(m_pending, [&](const Pending& p) { return m_heaps[p.heap].stats.freed >= p.freedTarget; });
+
+        for (uint32_t i = 0; i < m_heaps.size(); ++i) {
+            Heap& heap = m_heaps[i];
+            vk::DeviceSize pending = 0;
+            for (const Pending& p : m_pending) {
+                if (p.heap == i) pending += p.size;
+            }
+            vk::DeviceSize usage = heap.status.usage - std::min(pending, heap.status.usage);
+            double budget = static_cast<double>(heap.status.budget);
+            if (budget <= 0.0 || static_cast<double>(usage) <= budget * m_settings.evictAbove) {
+                heap.overBudget = false;
+                continue;
+            }
+
+            // 2. Oldest first, stopping at anything used too recently (the list is in use order)
+            vk::DeviceSize target = static_cast<vk::DeviceSize>(budget * m_settings.evictTo);
+            while (usage > target && !heap.lru.empty()) {
+                Resource& oldest = heap.lru.back();
+                if (oldest.lastUsed + m_settings.minIdleFrames > frame) break;
+
+                usage -= std::min(oldest.size, usage);
+                // Targets stack so that several evictions need all of their bytes freed
+                heap.freedTarget = std::max(heap.freedTarget, heap.stats.freed) + oldest.size;
+                m_pending.push_back({ i, oldest.size, heap.freedTarget });
+                m_evictions.add();
+                m_evictedBytes.add(oldest.size);
+                victims.push_back(std::move(oldest.evict));
+                m_lookup.erase(oldest.id);
+                heap.lru.pop_back();
+            }
+
+            if (usage > target && !heap.overBudget) {
+                std::println("memory budget: heap {} at {:.1f} of {:.1f} MiB with nothing idle left to evict",
+                    i, static_cast<double>(usage) / MIB, budget / MIB);
+            }
+            heap.overBudget = usage > target;
+        }
+        m_resources.set(static_cast<double>(m_lookup.size()));
+    }
+
+    // 3. Outside the lock: owners typically retire memory and may re-register replacements
+    for (auto& evict : victims) {
+        if (evict) evict();
+    }
+}
+
+std::vector<ResidencyManager::HeapStatus> ResidencyManager::heaps() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<HeapStatus> status;
+    status.reserve(m_heaps.size());
+    for (const Heap& heap : m_heaps) status.push_back(heap.status);
+    return status;
+}
+
+} // namespace Zeta
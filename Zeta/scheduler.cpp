@@ -0,0 +1,163 @@
+#include "Zeta/scheduler.hpp"
+#include "Zeta/jobs.hpp"
+#include "Zeta/profiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <print>
+#include <stdexcept>
+
+namespace Zeta {
+
+TaskScheduler& TaskScheduler::get() {
+    static TaskScheduler instance;
+    return instance;
+}
+
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+void TaskScheduler::spawn(Task<void> task) {
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    [](TaskScheduler* self, Task<void> inner) -> detail::DetachedTask {
+        try {
+            co_await inner;
+        } catch (const std::exception& e) {
+            std::println("task failed: {}", e.what());
+        } catch (...) {
+            std::println("task failed: unknown exception");
+        }
+        self->m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+    }(this, std::move(task));
+}
+
+size_t TaskScheduler::run_main_queue() {
+    std::deque<std::coroutine_handle<>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        ready.swap(m_mainQueue);
+    }
+    if (ready.empty()) return 0;
+
+    ZETA_ZONE("TaskScheduler::run_main_queue");
+    // Only what was queued before this call runs now; anything it queues waits for the next frame
+    for (auto handle : ready) handle.resume();
+    return ready.size();
+}
+
+void TaskScheduler::resume(std::coroutine_handle<> handle, ResumeOn where) {
+    if (where == ResumeOn::Worker && Jobs::get().running()) {
+        Jobs::get().run([handle] { handle.resume(); });
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    m_mainQueue.push_back(handle);
+}
+
+// --- GPU timeline watcher ---
+
+void TaskScheduler::watch(const vk::raii::Semaphore& semaphore, uint64_t value, std::coroutine_handle<> handle, ResumeOn where) {
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    if (!m_watcher.joinable()) {
+        m_watcher = std::jthread([this](std::stop_token stop) { watcher_loop(stop); });
+    }
+    m_watches.push_back({ &semaphore, value, handle, where });
+    m_watchCv.notify_one();
+}
+
+size_t TaskScheduler::watched() const {
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    return m_watches.size();
+}
+
+void TaskScheduler::watcher_loop(std::stop_token stop) {
+    ZETA_THREAD_NAME("gpu_watcher");
+    std::vector<Watch> ready;
+    std::vector<std::pair<const vk::raii::Semaphore*, uint64_t>> counters;
+
+    while (!stop.stop_requested()) {
+        {
+            std::unique_lock<std::mutex> lock(m_watchMutex);
+            // Sleep outright when nothing is pending instead of polling an idle GPU
+            if (!m_watchCv.wait(lock, stop, [&] { return !m_watches.empty(); })) break;
+
+            // 1. One counter query per distinct semaphore per sweep
+            counters.clear();
+            for (auto it = m_watches.begin(); it != m_watches.end();) {
+                auto cached = std::find_if(counters.begin(), counters.end(), [&](const auto& c) { return c.first == it->semaphore; });
+                uint64_t current = cached != counters.end() ? cached->second
+                                                            : counters.emplace_back(it->semaphore, it->semaphore->getCounterValue()).second;
+                if (current >= it->value) {
+                    ready.push_back(*it);
+                    *it = m_watches.back();
+                    m_watches.pop_back();
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // 2. Resume outside the lock: a resumed coroutine may well register the next wait
+        for (const Watch& watch : ready) resume(watch.handle, watch.where);
+        ready.clear();
+
+        std::this_thread::sleep_for(WATCH_INTERVAL);
+    }
+}
+
+// --- Blocking I/O ---
+
+void TaskScheduler::post_io(std::function<void()> fn) {
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    if (!m_ioThread.joinable()) {
+        m_ioThread = std::jthread([this](std::stop_token stop) { io_loop(stop); });
+    }
+    m_ioQueue.push_back(std::move(fn));
+    m_ioCv.notify_one();
+}
+
+void TaskScheduler::io_loop(std::stop_token stop) {
+    ZETA_THREAD_NAME("task_io");
+    while (true) {
+        std::function<void()> fn;
+        {
+            std::unique_lock<std::mutex> lock(m_ioMutex);
+            if (!m_ioCv.wait(lock, stop, [&] { return !m_ioQueue.empty(); })) return;
+            fn = std::move(m_ioQueue.front());
+            m_ioQueue.pop_front();
+        }
+        fn();
+    }
+}
+
+Task<std::vector<uint8_t>> TaskScheduler::read_file(std::string path, ResumeOn where) {
+    std::vector<uint8_t> data;
+    co_await offload([&] {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Failed to open " + path);
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }, where);
+    co_return data;
+}
+
+void TaskScheduler::shutdown() {
+    if (m_watcher.joinable()) {
+        m_watcher.request_stop();
+        m_watcher.join();
+    }
+    if (m_ioThread.joinable()) {
+        m_ioThread.request_stop();
+        m_ioThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    if (!m_watches.empty() || m_inFlight.load(std::memory_order_relaxed) > 0) {
+        std::println("task scheduler: shutting down with {} GPU wait(s), {} task(s) unfinished",
+            m_watches.size(), m_inFlight.load(std::memory_order_relaxed));
+    }
+    m_watches.clear();
+}
+
+} // namespace Zeta
@@ -0,0 +1,105 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/swapchain_policy.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace Zeta {
+
+namespace {
+
+struct ProfileRules {
+    std::array<vk::PresentModeKHR, 3> presentModes; // Preference order, FIFO last
+    uint32_t extraImages;                           // On top of minImageCount
+    std::array<vk::Format, 4> formats;              // Preference order, all sRGB-nonlinear
+};
+
+constexpr std::array<vk::Format, 4> WIDE_FORMATS = {
+    vk::Format::eA2B10G10R10UnormPack32, vk::Format::eA2R10G10B10UnormPack32,
+    vk::Format::eB8G8R8A8Unorm, vk::Format::eR8G8B8A8Unorm
+};
+constexpr std::array<vk::Format, 4> NARROW_FORMATS = {
+    vk::Format::eB8G8R8A8Unorm, vk::Format::eR8G8B8A8Unorm,
+    vk::Format::eA2B10G10R10UnormPack32, vk::Format::eA2R10G10B10UnormPack32
+};
+
+ProfileRules rules_for(SwapchainProfile profile) {
+    switch (profile) {
+    case SwapchainProfile::LowLatency:
+        return { { vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eFifo }, 1, WIDE_FORMATS };
+    case SwapchainProfile::Throughput:
+        return { { vk::PresentModeKHR::eFifoRelaxed, vk::PresentModeKHR::eFifo, vk::PresentModeKHR::eFifo }, 2, WIDE_FORMATS };
+    case SwapchainProfile::PowerSaver:
+        return { { vk::PresentModeKHR::eFifo, vk::PresentModeKHR::eFifo, vk::PresentModeKHR::eFifo }, 0, NARROW_FORMATS };
+    }
+    throw std::runtime_error("unknown swapchain profile");
+}
+
+}
+
+const char* profile_name(SwapchainProfile profile) {
+    switch (profile) {
+    case SwapchainProfile::LowLatency: return "low-latency";
+    case SwapchainProfile::Throughput: return "throughput";
+    case SwapchainProfile::PowerSaver: return "power-saver";
+    }
+    return "unknown";
+}
+
+std::optional<SwapchainProfile> parse_swapchain_profile(std::string_view name) {
+    for (auto profile : { SwapchainProfile::LowLatency, SwapchainProfile::Throughput, SwapchainProfile::PowerSaver }) {
+        if (name == profile_name(profile)) return profile;
+    }
+    return std::nullopt;
+}
+
+SwapchainChoice choose_swapchain(SwapchainProfile profile,
+                                 const vk::SurfaceCapabilitiesKHR& capabilities,
+                                 std::span<const vk::PresentModeKHR> presentModes,
+                                 std::span<const vk::SurfaceFormatKHR> formats) {
+    if (formats.empty()) throw std::runtime_error("surface reports no formats");
+    ProfileRules rules = rules_for(profile);
+    SwapchainChoice choice;
+
+    // 1. Present mode: first wish the surface supports; FIFO even if (wrongly) unreported
+    auto mode = std::find_if(rules.presentModes.begin(), rules.presentModes.end(), [&](vk::PresentModeKHR m) {
+        return std::find(presentModes.begin(), presentModes.end(), m) != presentModes.end();
+    });
+    choice.presentMode = mode != rules.presentModes.end() ? *mode : vk::PresentModeKHR::eFifo;
+    choice.fallback = choice.presentMode != rules.presentModes.front();
+
+    // 2. Image count: mailbox/immediate only need the extra image when mailbox is what we got
+    uint32_t extra = rules.extraImages;
+    if (profile == SwapchainProfile::LowLatency && choice.presentMode != vk::PresentModeKHR::eMailbox) extra = 0;
+    choice.imageCount = std::max(capabilities.minImageCount + extra, 2u);
+    if (capabilities.maxImageCount > 0) choice.imageCount = std::min(choice.imageCount, capabilities.maxImageCount);
+
+    // 3. Format: sRGB-nonlinear colour space only, anything reported as the last resort
+    choice.format = formats.front();
+    bool found = false;
+    for (vk::Format wanted : rules.formats) {
+        auto it = std::find_if(formats.begin(), formats.end(), [&](const vk::SurfaceFormatKHR& f) {
+            return f.format == wanted && f.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear;
+        });
+        if (it != formats.end()) {
+            choice.format = *it;
+            choice.fallback |= wanted != rules.formats.front();
+            found = true;
+            break;
+        }
+    }
+    choice.fallback |= !found;
+
+    // 4. Opaque when possible; otherwise whatever the compositor accepts
+    if (!(capabilities.supportedCompositeAlpha & vk::CompositeAlphaFlagBitsKHR::eOpaque)) {
+        for (auto bit : { vk::CompositeAlphaFlagBitsKHR::ePreMultiplied, vk::CompositeAlphaFlagBitsKHR::ePostMultiplied, vk::CompositeAlphaFlagBitsKHR::eInherit }) {
+            if (capabilities.supportedCompositeAlpha & bit) {
+                choice.compositeAlpha = bit;
+                break;
+            }
+        }
+    }
+    return choice;
+}
+
+} // namespace Zeta
@@ -1,32 +1,145 @@
 #include <Zeta/time.hpp>
+#include <Zeta/metrics.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
-Fps::Fps() {};
-Fps::~Fps() {};
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+timespec to_timespec(std::chrono::steady_clock::time_point t) {
+	// steady_clock is CLOCK_MONOTONIC on Linux, so its epoch matches the kernel timers
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+	return { static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+}
+
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+}
+
+FramePacer::~FramePacer() {
+	if (m_timerFd >= 0) close(m_timerFd);
+}
+
+void FramePacer::setMode(SleepMode mode) {
+	if (mode == SleepMode::TimerFd && m_timerFd < 0) {
+		m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if (m_timerFd < 0) mode = SleepMode::ClockNanosleep;
+	}
+	m_mode = mode;
+}
+
+void FramePacer::wait(int limit) {
+	auto now = clock::now();
+	if (limit <= 0) {
+		m_lastLimit = limit;
+		return;
+	}
+
+	auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / limit));
+
+	// 1. Advance the absolute schedule, resyncing only when it no longer makes sense
+	if (limit != m_lastLimit || m_deadline == clock::time_point{} || now - m_deadline > period) {
+		m_deadline = now + period;
+		m_lastLimit = limit;
+	} else {
+		m_deadline += period;
+	}
+
+	if (now >= m_deadline) return; // Over budget, no waiting
+
+	// 2. Coarse sleep, stopping short by the calibrated margin
+	auto margin = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float, std::micro>(m_spinMarginUs));
+	auto sleepTarget = m_deadline - margin;
+	if (sleepTarget > now) {
+		sleep_until(sleepTarget);
+		float overshootUs = std::chrono::duration<float, std::micro>(clock::now() - sleepTarget).count();
+		calibrate(overshootUs);
+	}
 
-int elapsedTime = 0;
+	// 3. Spin out the remainder
+	while (clock::now() < m_deadline) cpu_relax();
+}
+
+void FramePacer::sleep_until(clock::time_point target) {
+	timespec ts = to_timespec(target);
+
+	// Default timer slack is 50 us; use the minimum for this sleep only. The slack is per thread
+	// and inherited by threads created later, so it is put back before returning.
+	int previousSlack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+	if (previousSlack > 0) prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+	switch (m_mode) {
+	case SleepMode::ClockNanosleep:
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+		break;
+	case SleepMode::TimerFd: {
+		itimerspec spec{ .it_interval = {}, .it_value = ts };
+		if (timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0) {
+			uint64_t expirations = 0;
+			while (read(m_timerFd, &expirations, sizeof(expirations)) < 0 && errno == EINTR) {}
+		}
+		break;
+	}
+	case SleepMode::SleepUntil:
+		std::this_thread::sleep_until(target);
+		break;
+	}
+
+	if (previousSlack > 0) prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(previousSlack), 0, 0, 0);
+}
+
+void FramePacer::calibrate(float overshootUs) {
+	// Track mean and spread of how late the OS wakes us; spin for mean + 3 deviations.
+	// Early wake-ups (negative overshoot) are clamped, they only cost a longer spin.
+	overshootUs = std::max(overshootUs, 0.0f);
+	constexpr float alpha = 0.1f;
+	m_overshootMeanUs += alpha * (overshootUs - m_overshootMeanUs);
+	m_overshootDevUs += alpha * (std::abs(overshootUs - m_overshootMeanUs) - m_overshootDevUs);
+	m_spinMarginUs = std::clamp(m_overshootMeanUs + 3.0f * m_overshootDevUs, 20.0f, 2000.0f);
+}
+
+Fps::Fps() {
+	m_frameHistogram = &Zeta::Metrics::get().histogram("frame_time_us");
+	m_workHistogram = &Zeta::Metrics::get().histogram("frame_work_us");
+};
+Fps::~Fps() {};
 
 void Fps::begin() {
-	m_start = std::chrono::steady_clock::now();
+	auto now = std::chrono::steady_clock::now();
+
+	// Begin-to-begin is the paced frame, including whatever the pacer slept
+	m_frameTime = std::chrono::duration<float, std::milli>(now - m_frame).count();
+	if (m_frameTime > 0.0f) m_fps = 1000.0f / m_frameTime;
+	m_frameHistogram->record(static_cast<uint64_t>(m_frameTime * 1000.0f));
+
+	m_frame = now;
+	m_start = now;
 };
 
 void Fps::end() {
-    auto now = std::chrono::steady_clock::now();
-    
-    // 1. Get exact work time in microseconds (float for precision)
-    float workTimeUs = std::chrono::duration<float, std::micro>(now - m_start).count();
-    float targetUs = 1000000.0f / m_limit;
-
-    if (workTimeUs < targetUs) {
-        float delayUs = targetUs - workTimeUs;
-        
-        // 2. Sleep until EXACTLY one frame duration from the start
-        std::this_thread::sleep_until(m_start + std::chrono::microseconds(static_cast<long long>(targetUs)));
-        
-        m_fps = m_limit; // We hit the cap
-    } else {
-        // 3. We ran slow, calculate actual FPS
-        m_fps = 1000000.0f / workTimeUs;
-    }
+	auto now = std::chrono::steady_clock::now();
+
+	// 1. The real cost of the frame, independent of the cap
+	m_workTime = std::chrono::duration<float, std::milli>(now - m_start).count();
+	m_workHistogram->record(static_cast<uint64_t>(m_workTime * 1000.0f));
+
+	// 2. Hold the frame until the next deadline
+	m_pacer.wait(m_limit);
+	m_delay = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - now).count();
 }
 
 float Fps::getFps() {
@@ -43,4 +156,4 @@ void Timer::end(){
 };
 float Timer::getFps(){
 	return m_frameTime;
-};
+};
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "Zeta/tlsf.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace Zeta {
+
+Tlsf::Tlsf(uint64_t capacity) : m_capacity(capacity) {
+    for (auto& row : m_heads) row.fill(INVALID);
+    if (capacity > 0) insert_free(new_node(0, capacity));
+}
+
+std::pair<uint32_t, uint32_t> Tlsf::mapping(uint64_t size) {
+    // Small sizes share first level 0, split linearly; above that each power of two gets SL_COUNT classes
+    if (size < (uint64_t{1} << SMALL_LOG2)) {
+        return { 0u, static_cast<uint32_t>(size >> (SMALL_LOG2 - SL_LOG2)) };
+    }
+    uint32_t msb = 63u - static_cast<uint32_t>(std::countl_zero(size));
+    uint32_t sl = static_cast<uint32_t>(size >> (msb - SL_LOG2)) ^ SL_COUNT;
+    return { msb - SMALL_LOG2 + 1, sl };
+}
+
+uint32_t Tlsf::find_free(uint64_t size) const {
+    // Round up to the next class boundary so any block found is large enough ("good fit")
+    uint32_t msb = 63u - static_cast<uint32_t>(std::countl_zero(size | 1));
+    uint64_t round = (uint64_t{1} << (std::max(msb, SMALL_LOG2) - SL_LOG2)) - 1;
+    if (size > UINT64_MAX - round) return INVALID;
+    size += round;
+    auto [fl, sl] = mapping(size);
+    if (fl >= FL_COUNT) return INVALID;
+
+    uint32_t slMap = sl < SL_COUNT ? m_slBitmap[fl] & (~0u << sl) : 0;
+    if (slMap == 0) {
+        uint64_t flMap = fl + 1 < 64 ? m_flBitmap & (~uint64_t{0} << (fl + 1)) : 0;
+        if (flMap == 0) return INVALID;
+        fl = static_cast<uint32_t>(std::countr_zero(flMap));
+        slMap = m_slBitmap[fl];
+    }
+    return m_heads[fl][std::countr_zero(slMap)];
+}
+
+std::optional<Tlsf::Range> Tlsf::allocate(uint64_t size, uint64_t alignment) {
+    size = std::max<uint64_t>(size, 1);
+    alignment = std::max<uint64_t>(alignment, 1);
+
+    // 1. Any block this search finds has room for the worst-case alignment padding
+    uint32_t index = find_free(size + alignment - 1);
+    if (index == INVALID) return std::nullopt;
+    remove_free(index);
+
+    // 2. Alignment padding in front becomes its own free range (the neighbour before a free
+    //    block is never free, so there is nothing to coalesce it with)
+    uint64_t aligned = (m_nodes[index].offset + alignment - 1) / alignment * alignment;
+    if (uint64_t pad = aligned - m_nodes[index].offset; pad > 0) {
+        uint32_t front = new_node(m_nodes[index].offset, pad);
+        Node& node = m_nodes[index];
+        m_nodes[front].prevPhys = node.prevPhys;
+        m_nodes[front].nextPhys = index;
+        if (node.prevPhys != INVALID) m_nodes[node.prevPhys].nextPhys = front;
+        node.prevPhys = front;
+        node.offset = aligned;
+        node.size -= pad;
+        insert_free(front);
+    }
+
+    // 3. Split off the tail when it is worth tracking
+    if (m_nodes[index].size - size >= MIN_SPLIT) {
+        uint32_t tail = new_node(m_nodes[index].offset + size, m_nodes[index].size - size);
+        Node& node = m_nodes[index];
+        m_nodes[tail].prevPhys = index;
+        m_nodes[tail].nextPhys = node.nextPhys;
+        if (node.nextPhys != INVALID) m_nodes[node.nextPhys].prevPhys = tail;
+        node.nextPhys = tail;
+        node.size = size;
+        insert_free(tail);
+    }
+
+    Node& node = m_nodes[index];
+    node.free = false;
+    m_used += node.size;
+    ++m_allocations;
+    return Range{ node.offset, node.size, index };
+}
+
+void Tlsf::free(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.free = true;
+    m_used -= node.size;
+    --m_allocations;
+
+    // Coalesce with free neighbours so free ranges never touch
+    if (uint32_t next = node.nextPhys; next != INVALID && m_nodes[next].free) {
+        remove_free(next);
+        node.size += m_nodes[next].size;
+        node.nextPhys = m_nodes[next].nextPhys;
+        if (node.nextPhys != INVALID) m_nodes[node.nextPhys].prevPhys = index;
+        release_node(next);
+    }
+    if (uint32_t prev = m_nodes[index].prevPhys; prev != INVALID && m_nodes[prev].free) {
+        remove_free(prev);
+        m_nodes[prev].size += m_nodes[index].size;
+        m_nodes[prev].nextPhys = m_nodes[index].nextPhys;
+        if (m_nodes[prev].nextPhys != INVALID) m_nodes[m_nodes[prev].nextPhys].prevPhys = prev;
+        release_node(index);
+        index = prev;
+    }
+    insert_free(index);
+}
+
+uint64_t Tlsf::largest_free() const {
+    if (m_flBitmap == 0) return 0;
+    // The largest free range sits somewhere in the highest non-empty first level
+    uint32_t fl = 63u - static_cast<uint32_t>(std::countl_zero(m_flBitmap));
+    uint64_t largest = 0;
+    for (uint32_t sl = 0; sl < SL_COUNT; ++sl) {
+        for (uint32_t i = m_heads[fl][sl]; i != INVALID; i = m_nodes[i].nextFree) largest = std::max(largest, m_nodes[i].size);
+    }
+    return largest;
+}
+
+uint32_t Tlsf::free_range_count() const {
+    uint32_t count = 0;
+    for (const auto& row : m_heads) {
+        for (uint32_t head : row) {
+            for (uint32_t i = head; i != INVALID; i = m_nodes[i].nextFree) ++count;
+        }
+    }
+    return count;
+}
+
+void Tlsf::insert_free(uint32_t index) {
+    Node& node = m_nodes[index];
+    auto [fl, sl] = mapping(node.size);
+    node.free = true;
+    node.prevFree = INVALID;
+    node.nextFree = m_heads[fl][sl];
+    if (node.nextFree != INVALID) m_nodes[node.nextFree].prevFree = index;
+    m_heads[fl][sl] = index;
+    m_flBitmap |= uint64_t{1} << fl;
+    m_slBitmap[fl] |= 1u << sl;
+}
+
+void Tlsf::remove_free(uint32_t index) {
+    Node& node = m_nodes[index];
+    auto [fl, sl] = mapping(node.size);
+    if (node.prevFree != INVALID) m_nodes[node.prevFree].nextFree = node.nextFree;
+    else m_heads[fl][sl] = node.nextFree;
+    if (node.nextFree != INVALID) m_nodes[node.nextFree].prevFree = node.prevFree;
+
+    if (m_heads[fl][sl] == INVALID) {
+        m_slBitmap[fl] &= ~(1u << sl);
+        if (m_slBitmap[fl] == 0) m_flBitmap &= ~(uint64_t{1} << fl);
+    }
+}
+
+uint32_t Tlsf::new_node(uint64_t offset, uint64_t size) {
+    Node node{ offset, size, INVALID, INVALID, INVALID, INVALID, false };
+    if (!m_spareNodes.empty()) {
+        uint32_t index = m_spareNodes.back();
+        m_spareNodes.pop_back();
+        m_nodes[index] = node;
+        return index;
+    }
+    m_nodes.push_back(node);
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void Tlsf::release_node(uint32_t index) {
+    m_spareNodes.push_back(index);
+}
+
+} // namespace Zeta
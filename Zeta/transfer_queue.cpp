@@ -0,0 +1,301 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/transfer_queue.hpp"
+#include "Zeta/profiler.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Zeta {
+
+TransferQueue::~TransferQueue() {
+    // Batches and staging may still be in use; wait for our own timeline only
+    if (m_device && m_submitted > 0) {
+        vk::SemaphoreWaitInfo waitInfo{ .semaphoreCount = 1, .pSemaphores = &(*m_timeline), .pValues = &m_submitted };
+        (void)m_device->waitSemaphores(waitInfo, UINT64_MAX);
+    }
+}
+
+void TransferQueue::init(const vk::raii::Device& device, GpuAllocator& allocator, const vk::raii::Queue& queue, uint32_t queueFamily,
+                         uint32_t graphicsFamily, vk::DeviceSize stagingSize) {
+    m_device = &device;
+    m_allocator = &allocator;
+    m_queue = &queue;
+    m_queueFamily = queueFamily;
+    m_graphicsFamily = graphicsFamily;
+
+    // 1. Command buffers are recycled one batch at a time
+    m_pool = vk::raii::CommandPool(device, vk::CommandPoolCreateInfo{
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        .queueFamilyIndex = queueFamily
+    });
+
+    vk::SemaphoreTypeCreateInfo timelineType{ .semaphoreType = vk::SemaphoreType::eTimeline, .initialValue = 0 };
+    m_timeline = vk::raii::Semaphore(device, vk::SemaphoreCreateInfo{ .pNext = &timelineType });
+
+    // 2. Staging ring, mapped for its whole life
+    m_stagingSize = stagingSize;
+    m_staging = vk::raii::Buffer(device, vk::BufferCreateInfo{
+        .size = stagingSize,
+        .usage = vk::BufferUsageFlagBits::eTransferSrc,
+        .sharingMode = vk::SharingMode::eExclusive
+    });
+    m_stagingMemory = allocator.bind(m_staging, MemoryUsage::Upload);
+    if (!m_stagingMemory.mapped()) throw std::runtime_error("transfer queue: staging memory is not host-visible");
+}
+
+// --- Staging ring ---
+
+void TransferQueue::reclaim_staging(uint64_t completed) {
+    // Ring order: a slow entry at the front holds back newer ones behind it
+    while (!m_stagingEntries.empty() && m_stagingEntries.front().value <= completed) {
+        m_stagingEntries.pop_front();
+        ++m_stagingFrontId;
+    }
+    if (m_stagingEntries.empty()) m_stagingHead = 0;
+}
+
+TransferQueue::Staging TransferQueue::stage(vk::DeviceSize size, vk::DeviceSize alignment) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reclaim_staging(m_timeline.getCounterValue());
+
+    // In use: [tail, head) until the head wraps, then [tail, end) + [0, head). A new entry begins at
+    // the old head, so padding and the waste skipped by a wrap are freed along with it.
+    size = std::max<vk::DeviceSize>(size, 1);
+    vk::DeviceSize begin = m_stagingHead;
+    vk::DeviceSize offset = (begin + alignment - 1) / alignment * alignment;
+    vk::DeviceSize tail = m_stagingEntries.empty() ? 0 : m_stagingEntries.front().begin;
+    bool wrapped = !m_stagingEntries.empty() && begin <= tail;
+    bool fits = wrapped ? offset + size <= tail : offset + size <= m_stagingSize;
+    if (!fits && !wrapped && !m_stagingEntries.empty() && size <= tail) {
+        offset = 0;
+        fits = true;
+    }
+    if (!fits) {
+        m_stagingFull.add();
+        return {};
+    }
+
+    m_stagingEntries.push_back({ begin, offset + size, PENDING });
+    m_stagingHead = offset + size;
+    m_stagingUsed.set(static_cast<double>(staging_used_locked()));
+    return Staging{
+        .data = static_cast<std::byte*>(m_stagingMemory.mapped()) + offset,
+        .buffer = *m_staging,
+        .offset = offset,
+        .size = size,
+        .id = m_stagingFrontId + m_stagingEntries.size() - 1
+    };
+}
+
+void TransferQueue::mark_staging(const Staging& staging, uint64_t value) {
+    if (staging.id < m_stagingFrontId) return;
+    uint64_t index = staging.id - m_stagingFrontId;
+    if (index < m_stagingEntries.size()) m_stagingEntries[index].value = value;
+}
+
+void TransferQueue::release(const Staging& staging) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Already copied: the copy's ticket frees it, not this call
+    if (staging.id < m_stagingFrontId) return;
+    uint64_t index = staging.id - m_stagingFrontId;
+    if (index < m_stagingEntries.size() && m_stagingEntries[index].value == PENDING) m_stagingEntries[index].value = 0;
+}
+
+vk::DeviceSize TransferQueue::staging_used_locked() const {
+    if (m_stagingEntries.empty()) return 0;
+    vk::DeviceSize tail = m_stagingEntries.front().begin;
+    return m_stagingHead > tail ? m_stagingHead - tail : m_stagingSize - tail + m_stagingHead;
+}
+
+vk::DeviceSize TransferQueue::staging_used() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return staging_used_locked();
+}
+
+// --- Batches ---
+
+TransferQueue::Batch& TransferQueue::open_batch() {
+    if (m_open) return *m_open;
+
+    // Reuse the oldest finished batch, or grow by one
+    uint64_t completed = m_timeline.getCounterValue();
+    auto it = std::find_if(m_batches.begin(), m_batches.end(), [&](const Batch& b) { return b.value != 0 && b.value <= completed; });
+    if (it == m_batches.end()) {
+        vk::raii::CommandBuffers buffers(*m_device, vk::CommandBufferAllocateInfo{
+            .commandPool = *m_pool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1
+        });
+        m_batches.push_back({ std::move(buffers.front()), 0 });
+        it = std::prev(m_batches.end());
+    } else {
+        it->cmd.reset();
+        it->value = 0;
+    }
+    it->cmd.begin({ .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+    m_open = &*it;
+    return *m_open;
+}
+
+uint64_t TransferQueue::copy(const Staging& staging, const BufferCopy& dst) {
+    // Upload memory is only preferably coherent: make the CPU writes visible before the GPU reads
+    m_allocator->flush(m_stagingMemory, staging.offset, staging.size);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Batch& batch = open_batch();
+    uint64_t ticket = m_submitted + 1;
+    mark_staging(staging, ticket);
+
+    batch.cmd.copyBuffer(staging.buffer, dst.buffer, vk::BufferCopy{
+        .srcOffset = staging.offset,
+        .dstOffset = dst.offset,
+        .size = staging.size
+    });
+
+    // Release to the graphics family, or on a shared queue a plain barrier into the consumers
+    vk::BufferMemoryBarrier2 barrier{
+        .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = dedicated() ? vk::PipelineStageFlagBits2::eNone : dst.dstStage,
+        .dstAccessMask = dedicated() ? vk::AccessFlagBits2::eNone : dst.dstAccess,
+        .srcQueueFamilyIndex = dedicated() ? m_queueFamily : VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = dedicated() ? m_graphicsFamily : VK_QUEUE_FAMILY_IGNORED,
+        .buffer = dst.buffer,
+        .offset = dst.offset,
+        .size = staging.size
+    };
+    batch.cmd.pipelineBarrier2({ .bufferMemoryBarrierCount = 1, .pBufferMemoryBarriers = &barrier });
+
+    if (dedicated()) {
+        // The acquire repeats the release with the other half of the dependency
+        barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+        barrier.dstStageMask = dst.dstStage;
+        barrier.dstAccessMask = dst.dstAccess;
+        m_openAcquire.buffers.push_back(barrier);
+    }
+    m_bytes.add(staging.size);
+    return ticket;
+}
+
+uint64_t TransferQueue::copy(const Staging& staging, const ImageCopy& dst) {
+    m_allocator->flush(m_stagingMemory, staging.offset, staging.size);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Batch& batch = open_batch();
+    uint64_t ticket = m_submitted + 1;
+    mark_staging(staging, ticket);
+
+    vk::ImageSubresourceRange range{
+        .aspectMask = dst.subresource.aspectMask,
+        .baseMipLevel = dst.subresource.mipLevel,
+        .levelCount = 1,
+        .baseArrayLayer = dst.subresource.baseArrayLayer,
+        .layerCount = dst.subresource.layerCount
+    };
+
+    // 1. Undefined -> TransferDst: the region is overwritten whole
+    vk::ImageMemoryBarrier2 toCopy{
+        .srcStageMask = vk::PipelineStageFlagBits2::eNone,
+        .dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+        .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .oldLayout = vk::ImageLayout::eUndefined,
+        .newLayout = vk::ImageLayout::eTransferDstOptimal,
+        .image = dst.image,
+        .subresourceRange = range
+    };
+    batch.cmd.pipelineBarrier2({ .imageMemoryBarrierCount = 1, .pImageMemoryBarriers = &toCopy });
+
+    // 2. Tightly packed rows
+    batch.cmd.copyBufferToImage(staging.buffer, dst.image, vk::ImageLayout::eTransferDstOptimal, vk::BufferImageCopy{
+        .bufferOffset = staging.offset,
+        .imageSubresource = dst.subresource,
+        .imageOffset = dst.offset,
+        .imageExtent = dst.extent
+    });
+
+    // 3. TransferDst -> final layout; with a dedicated family the release and acquire pair both
+    //    carry the transition, which happens once between them
+    vk::ImageMemoryBarrier2 barrier{
+        .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = dedicated() ? vk::PipelineStageFlagBits2::eNone : dst.dstStage,
+        .dstAccessMask = dedicated() ? vk::AccessFlagBits2::eNone : dst.dstAccess,
+        .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+        .newLayout = dst.finalLayout,
+        .srcQueueFamilyIndex = dedicated() ? m_queueFamily : VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = dedicated() ? m_graphicsFamily : VK_QUEUE_FAMILY_IGNORED,
+        .image = dst.image,
+        .subresourceRange = range
+    };
+    batch.cmd.pipelineBarrier2({ .imageMemoryBarrierCount = 1, .pImageMemoryBarriers = &barrier });
+
+    if (dedicated()) {
+        barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+        barrier.dstStageMask = dst.dstStage;
+        barrier.dstAccessMask = dst.dstAccess;
+        m_openAcquire.images.push_back(barrier);
+    }
+    m_bytes.add(staging.size);
+    return ticket;
+}
+
+uint64_t TransferQueue::submit() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open) return m_submitted;
+
+    ZETA_ZONE("TransferQueue::submit");
+    m_open->cmd.end();
+    m_open->value = ++m_submitted;
+
+    vk::CommandBufferSubmitInfo cmdInfo{ .commandBuffer = *m_open->cmd };
+    vk::SemaphoreSubmitInfo signal{ .semaphore = *m_timeline, .value = m_submitted, .stageMask = vk::PipelineStageFlagBits2::eAllCommands };
+    m_queue->submit2(vk::SubmitInfo2{
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &cmdInfo,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &signal
+    });
+    m_batchCount.add();
+    m_stagingUsed.set(static_cast<double>(staging_used_locked()));
+
+    if (dedicated()) {
+        m_openAcquire.value = m_submitted;
+        m_acquires.push_back(std::move(m_openAcquire));
+        m_openAcquire = {};
+    }
+    m_open = nullptr;
+    return m_submitted;
+}
+
+uint64_t TransferQueue::record_acquires(const vk::raii::CommandBuffer& cmd) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!dedicated()) {
+        // Same queue: every submitted batch is ordered before this frame and its barrier covers it
+        m_acquired.store(m_submitted, std::memory_order_release);
+        return 0;
+    }
+
+    // Only finished batches: the frame's wait on the transfer timeline is then already satisfied
+    uint64_t completed = m_timeline.getCounterValue();
+    std::vector<vk::BufferMemoryBarrier2> buffers;
+    std::vector<vk::ImageMemoryBarrier2> images;
+    uint64_t waitValue = 0;
+    while (!m_acquires.empty() && m_acquires.front().value <= completed) {
+        Acquire& acquire = m_acquires.front();
+        buffers.insert(buffers.end(), acquire.buffers.begin(), acquire.buffers.end());
+        images.insert(images.end(), acquire.images.begin(), acquire.images.end());
+        waitValue = acquire.value;
+        m_acquires.pop_front();
+    }
+    if (waitValue == 0) return 0;
+
+    cmd.pipelineBarrier2({
+        .bufferMemoryBarrierCount = static_cast<uint32_t>(buffers.size()),
+        .pBufferMemoryBarriers = buffers.data(),
+        .imageMemoryBarrierCount = static_cast<uint32_t>(images.size()),
+        .pImageMemoryBarriers = images.data()
+    });
+    m_acquired.store(waitValue, std::memory_order_release);
+    return waitValue;
+}
+
+} // namespace Zeta
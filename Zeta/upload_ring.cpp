@@ -0,0 +1,99 @@
+#define VULKAN_HPP_NO_STRUCT_CONSTRUCTORS
+#include "Zeta/upload_ring.hpp"
+#include "Zeta/profiler.hpp"
+#include <algorithm>
+#include <print>
+#include <stdexcept>
+
+namespace Zeta {
+
+void UploadRing::init(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice, GpuAllocator& allocator,
+                      const vk::raii::Semaphore& timeline, uint32_t regionCount, vk::DeviceSize regionSize) {
+    m_device = &device;
+    m_allocator = &allocator;
+    m_timeline = &timeline;
+
+    // 1. Regions start on boundaries every kind of binding and every flush accepts
+    auto limits = physicalDevice.getProperties().limits;
+    m_uniformAlignment = std::max<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+    m_storageAlignment = std::max<vk::DeviceSize>(limits.minStorageBufferOffsetAlignment, 1);
+    vk::DeviceSize regionAlignment = std::max({ m_uniformAlignment, m_storageAlignment, VERTEX_ALIGNMENT,
+                                                static_cast<vk::DeviceSize>(limits.nonCoherentAtomSize) });
+    m_regionSize = (regionSize + regionAlignment - 1) / regionAlignment * regionAlignment;
+    m_regionFrames.assign(regionCount, 0);
+
+    // 2. One buffer for every region, mapped for its whole life by the allocator
+    m_buffer = vk::raii::Buffer(device, vk::BufferCreateInfo{
+        .size = m_regionSize * regionCount,
+        .usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+                 vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer |
+                 vk::BufferUsageFlagBits::eTransferSrc,
+        .sharingMode = vk::SharingMode::eExclusive
+    });
+    m_memory = allocator.bind(m_buffer, MemoryUsage::Upload);
+    if (!m_memory.mapped()) throw std::runtime_error("upload ring: memory is not host-visible");
+}
+
+void UploadRing::begin_frame(uint32_t slot, uint64_t frameValue, uint64_t completedValue) {
+    // The frame loop normally waits for the slot already; a region outliving its slot's wait
+    // (e.g. fewer regions than slots) is caught here rather than overwritten under the GPU
+    m_slot = slot % static_cast<uint32_t>(m_regionFrames.size());
+    uint64_t lastValue = m_regionFrames[m_slot];
+    if (lastValue > completedValue && m_timeline->getCounterValue() < lastValue) {
+        ZETA_ZONE("upload_ring_stall");
+        m_stalls.add();
+        vk::SemaphoreWaitInfo waitInfo{
+            .semaphoreCount = 1,
+            .pSemaphores = &(**m_timeline),
+            .pValues = &lastValue
+        };
+        (void)m_device->waitSemaphores(waitInfo, UINT64_MAX);
+    }
+
+    m_regionFrames[m_slot] = frameValue;
+    m_frameValue = frameValue;
+    m_head.store(0, std::memory_order_relaxed);
+    m_overrunBytes.store(0, std::memory_order_relaxed);
+    m_overruns.store(0, std::memory_order_relaxed);
+}
+
+void UploadRing::end_frame() {
+    vk::DeviceSize used = std::min(m_head.load(std::memory_order_acquire), m_regionSize);
+    if (used > 0) m_allocator->flush(m_memory, m_slot * m_regionSize, used);
+    m_frameBytes.record(used);
+
+    // Log once per run of overrunning frames; upload_ring_overruns counts every one
+    uint32_t overruns = m_overruns.load(std::memory_order_relaxed);
+    if (overruns > 0) {
+        m_overrunCounter.add(overruns);
+        if (!m_overrunning) {
+            std::println("upload ring: frame {} overran its {} KiB region, {} allocation(s) ({} KiB) dropped",
+                m_frameValue, m_regionSize / 1024, overruns, m_overrunBytes.load(std::memory_order_relaxed) / 1024);
+        }
+    }
+    m_overrunning = overruns > 0;
+}
+
+UploadRing::Slice UploadRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment) {
+    // CAS bump: recording threads race for the same region without a lock
+    vk::DeviceSize head = m_head.load(std::memory_order_relaxed);
+    vk::DeviceSize offset;
+    do {
+        offset = (head + alignment - 1) / alignment * alignment;
+        if (offset + size > m_regionSize) {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            m_overrunBytes.fetch_add(size, std::memory_order_relaxed);
+            return {};
+        }
+    } while (!m_head.compare_exchange_weak(head, offset + size, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    vk::DeviceSize bufferOffset = m_slot * m_regionSize + offset;
+    return Slice{
+        .data = static_cast<std::byte*>(m_memory.mapped()) + bufferOffset,
+        .buffer = *m_buffer,
+        .offset = bufferOffset,
+        .size = size
+    };
+}
+
+} // namespace Zeta
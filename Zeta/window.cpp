@@ -1,23 +1,83 @@
 #include "Zeta/window.hpp"
+#include "Zeta/profiler.hpp"
 #include <cstring>
 #include <stdexcept>
 #include "xdg-shell-client-protocol.h"
+#include "relative-pointer-unstable-v1-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+#include "viewporter-client-protocol.h"
+#include "fractional-scale-v1-client-protocol.h"
 
 #include <linux/input-event-codes.h>
 #include <print>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 namespace Zeta {
 
 // Listener Definitions
 static const struct wl_registry_listener registry_listener = { .global = Window::handle_registry_global, .global_remove = [](auto...){} };
 static const struct xdg_wm_base_listener wm_base_listener = { .ping = Window::handle_xdg_wm_base_ping };
 static const struct xdg_surface_listener surface_listener = { .configure = Window::handle_xdg_surface_configure };
-static const struct xdg_toplevel_listener toplevel_listener = { .configure = Window::handle_xdg_toplevel_configure, .close = [](auto...){} };
+// xdg-shell v6 adds the suspended toplevel state; older protocol headers only get v1
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+static constexpr uint32_t XDG_WM_BASE_VERSION = XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION;
+#else
+static constexpr uint32_t XDG_WM_BASE_VERSION = 1;
+#endif
+static const struct xdg_toplevel_listener toplevel_listener = {
+    .configure = Window::handle_xdg_toplevel_configure, .close = [](auto...){},
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+    .configure_bounds = [](auto...){}, .wm_capabilities = [](auto...){}
+#endif
+};
+static const struct wp_fractional_scale_v1_listener fractional_scale_listener = { .preferred_scale = Window::handle_preferred_scale };
+static const struct wl_callback_listener frame_listener = { .done = Window::handle_frame_done };
 static const struct wl_seat_listener seat_listener = { .capabilities = Window::handle_seat_capabilities, .name = [](auto...){} };
 static const struct wl_keyboard_listener keyboard_listener = {
     .keymap = [](auto...){}, .enter = [](auto...){}, .leave = [](auto...){},
     .key = Window::handle_keyboard_key,
     .modifiers = [](auto...){}, .repeat_info = [](auto...){}
 };
+// wl_seat v7: the pointer events after axis_discrete are never sent
+static const struct wl_pointer_listener pointer_listener = {
+    .enter = [](auto...){}, .leave = [](auto...){},
+    .motion = Window::handle_pointer_motion,
+    .button = Window::handle_pointer_button,
+    .axis = [](auto...){}, .frame = [](auto...){}, .axis_source = [](auto...){},
+    .axis_stop = [](auto...){}, .axis_discrete = [](auto...){}
+};
+static const struct zwp_relative_pointer_v1_listener relative_pointer_listener = { .relative_motion = Window::handle_relative_motion };
+static const struct wp_presentation_listener presentation_listener = { .clock_id = Window::handle_presentation_clock };
+static const struct wp_presentation_feedback_listener feedback_listener = {
+    .sync_output = [](auto...){},
+    .presented = Window::handle_feedback_presented,
+    .discarded = Window::handle_feedback_discarded
+};
+
+// Wayland input times have an undefined base, but compositors use CLOCK_MONOTONIC in practice.
+// Trust a timestamp that lands within the last second, otherwise fall back to receipt time.
+static uint64_t input_time_ms(uint32_t ms) {
+    uint64_t now = event_clock_ns();
+    uint32_t age = static_cast<uint32_t>(now / 1'000'000) - ms; // Unsigned: survives the 49-day wrap
+    return age < 1000 ? now - uint64_t(age) * 1'000'000 : now;
+}
+
+static uint64_t input_time_us(uint32_t hi, uint32_t lo) {
+    uint64_t now = event_clock_ns();
+    uint64_t t = ((uint64_t(hi) << 32) | lo) * 1000;
+    return (t <= now && now - t < 1'000'000'000) ? t : now;
+}
+
+static uint64_t clock_ns(clockid_t clock) {
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return uint64_t(ts.tv_sec) * 1'000'000'000 + uint64_t(ts.tv_nsec);
+}
 
 static void output_handle_mode(void* data, struct wl_output*, uint32_t flags, int32_t w, int32_t h, int32_t) {
     if (flags & WL_OUTPUT_MODE_CURRENT) {
@@ -69,6 +129,13 @@ Window::Window(uint32_t width, uint32_t height) : m_width(width), m_height(heigh
     m_xdg_surface = xdg_wm_base_get_xdg_surface(m_xdg_wm_base, m_surface);
     xdg_surface_add_listener(m_xdg_surface, &surface_listener, this);
 
+    // Decouple the buffer size from the surface size before the first commit
+    if (m_viewporter) m_viewport = wp_viewporter_get_viewport(m_viewporter, m_surface);
+    if (m_fractionalScaleManager) {
+        m_fractionalScale = wp_fractional_scale_manager_v1_get_fractional_scale(m_fractionalScaleManager, m_surface);
+        wp_fractional_scale_v1_add_listener(m_fractionalScale, &fractional_scale_listener, this);
+    }
+
     m_xdg_toplevel = xdg_surface_get_toplevel(m_xdg_surface);
     xdg_toplevel_add_listener(m_xdg_toplevel, &toplevel_listener, this);
     xdg_toplevel_set_title(m_xdg_toplevel, "Zeta Engine");
@@ -86,33 +153,112 @@ Window::Window(uint32_t width, uint32_t height) : m_width(width), m_height(heigh
 }
 
 Window::~Window() {
+    stop_input_thread();
+    if (m_frameCallback) wl_callback_destroy(m_frameCallback);
+    for (auto& fb : m_feedback) wp_presentation_feedback_destroy(fb->feedback);
+    m_feedback.clear();
+    if (m_presentation) wp_presentation_destroy(m_presentation);
+    if (m_relativePointer) zwp_relative_pointer_v1_destroy(m_relativePointer);
+    if (m_relativePointerManager) zwp_relative_pointer_manager_v1_destroy(m_relativePointerManager);
+    if (m_pointer) wl_pointer_destroy(m_pointer);
     if (m_keyboard) wl_keyboard_destroy(m_keyboard);
     if (m_seat) wl_seat_destroy(m_seat);
+    if (m_fractionalScale) wp_fractional_scale_v1_destroy(m_fractionalScale);
+    if (m_fractionalScaleManager) wp_fractional_scale_manager_v1_destroy(m_fractionalScaleManager);
+    if (m_viewport) wp_viewport_destroy(m_viewport);
+    if (m_viewporter) wp_viewporter_destroy(m_viewporter);
     if (m_xdg_toplevel) xdg_toplevel_destroy(m_xdg_toplevel);
     if (m_xdg_surface) xdg_surface_destroy(m_xdg_surface);
     if (m_xdg_wm_base) xdg_wm_base_destroy(m_xdg_wm_base);
     if (m_surface) wl_surface_destroy(m_surface);
     if (m_compositor) wl_compositor_destroy(m_compositor);
     if (m_registry) wl_registry_destroy(m_registry);
+    if (m_inputQueue) wl_event_queue_destroy(m_inputQueue);
     if (m_display) wl_display_disconnect(m_display);
 }
 
-void Window::poll_events() {
-    // 1. Send any outgoing requests (like acks or pongs) to the compositor
-    if (wl_display_prepare_read(m_display) == 0) {
-        // 2. Read new events from the socket into the buffer
-        wl_display_read_events(m_display);
-    } else {
-        // If someone else already prepared a read, just dispatch what we have
-        wl_display_dispatch_pending(m_display);
-        return;
+bool Window::poll_events(int timeoutMs) {
+    ZETA_ZONE("Window::poll_events");
+    // 1. Events already read from the socket (possibly by the input thread) must be dispatched
+    //    before we are allowed to read again
+    while (wl_display_prepare_read(m_display) != 0) {
+        if (wl_display_dispatch_pending(m_display) < 0) return false;
     }
 
-    // 3. Process everything now in the buffer (triggers your callbacks)
-    wl_display_dispatch_pending(m_display);
-    
-    // 4. Ensure the display is flushed so the compositor sees our responses
+    // 2. Send any outgoing requests (like acks or pongs) to the compositor
     wl_display_flush(m_display);
+
+    // 3. Only read if the socket has data: a bare wl_display_read_events would block the frame
+    pollfd pfd{ .fd = wl_display_get_fd(m_display), .events = POLLIN, .revents = 0 };
+    if (poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN)) {
+        if (wl_display_read_events(m_display) < 0) return false;
+    } else {
+        wl_display_cancel_read(m_display);
+        if (pfd.revents & (POLLERR | POLLHUP)) return false;
+    }
+
+    // 4. Process everything now in the buffer (triggers your callbacks)
+    return wl_display_dispatch_pending(m_display) >= 0;
+}
+
+void Window::start_input_thread() {
+    if (m_inputThread.joinable() || !m_seat) return;
+
+    // 1. Seat and its devices move to a private queue; devices created later inherit it
+    //    (the relative pointer comes from its manager, so handle_seat_capabilities creates it through
+    //    a wrapper bound to this queue)
+    m_inputQueue = wl_display_create_queue(m_display);
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_seat), m_inputQueue);
+    if (m_keyboard) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_keyboard), m_inputQueue);
+    if (m_pointer) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_pointer), m_inputQueue);
+    if (m_relativePointer) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_relativePointer), m_inputQueue);
+
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    m_inputThread = std::jthread([this](std::stop_token stop) { input_loop(stop); });
+}
+
+void Window::stop_input_thread() {
+    if (!m_inputThread.joinable()) return;
+
+    m_inputThread.request_stop();
+    uint64_t one = 1;
+    (void)write(m_wakeFd, &one, sizeof(one));
+    m_inputThread.join();
+    close(m_wakeFd);
+    m_wakeFd = -1;
+
+    // Hand the devices back to the default queue so poll_events() keeps serving them
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_seat), nullptr);
+    if (m_keyboard) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_keyboard), nullptr);
+    if (m_pointer) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_pointer), nullptr);
+    if (m_relativePointer) wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(m_relativePointer), nullptr);
+    wl_display_dispatch_queue_pending(m_display, m_inputQueue);
+}
+
+void Window::input_loop(std::stop_token stop) {
+    ZETA_THREAD_NAME("input");
+    while (!stop.stop_requested()) {
+        // Same prepare/poll/read-or-cancel dance as poll_events(), on our queue and without a timeout:
+        // this thread exists to sleep until input arrives
+        while (wl_display_prepare_read_queue(m_display, m_inputQueue) != 0) {
+            if (wl_display_dispatch_queue_pending(m_display, m_inputQueue) < 0) return;
+        }
+        wl_display_flush(m_display);
+
+        pollfd fds[2] = {
+            { .fd = wl_display_get_fd(m_display), .events = POLLIN, .revents = 0 },
+            { .fd = m_wakeFd, .events = POLLIN, .revents = 0 }
+        };
+        if (poll(fds, 2, -1) > 0 && (fds[0].revents & POLLIN)) {
+            if (wl_display_read_events(m_display) < 0) return;
+        } else {
+            wl_display_cancel_read(m_display);
+            if (fds[0].revents & (POLLERR | POLLHUP)) return;
+        }
+
+        ZETA_ZONE("Window::dispatch_input");
+        if (wl_display_dispatch_queue_pending(m_display, m_inputQueue) < 0) return;
+    }
 }
 
 // Static Handlers
@@ -121,7 +267,7 @@ void Window::handle_registry_global(void* data, struct wl_registry* reg, uint32_
     if (strcmp(intf, "wl_compositor") == 0) {
         self->m_compositor = (wl_compositor*)wl_registry_bind(reg, id, &wl_compositor_interface, 4);
     } else if (strcmp(intf, "xdg_wm_base") == 0) {
-        self->m_xdg_wm_base = (xdg_wm_base*)wl_registry_bind(reg, id, &xdg_wm_base_interface, 1);
+        self->m_xdg_wm_base = (xdg_wm_base*)wl_registry_bind(reg, id, &xdg_wm_base_interface, std::min(ver, XDG_WM_BASE_VERSION));
         xdg_wm_base_add_listener(self->m_xdg_wm_base, &wm_base_listener, self);
     } else if (strcmp(intf, "wl_seat") == 0) {
         self->m_seat = (wl_seat*)wl_registry_bind(reg, id, &wl_seat_interface, 7);
@@ -129,6 +275,15 @@ void Window::handle_registry_global(void* data, struct wl_registry* reg, uint32_
     } else if (strcmp(intf, "wl_output") == 0) {
         self->m_output = (struct wl_output*)wl_registry_bind(reg, id, &wl_output_interface, 2);
         wl_output_add_listener(self->m_output, &output_listener, self);
+    } else if (strcmp(intf, zwp_relative_pointer_manager_v1_interface.name) == 0) {
+        self->m_relativePointerManager = (zwp_relative_pointer_manager_v1*)wl_registry_bind(reg, id, &zwp_relative_pointer_manager_v1_interface, 1);
+    } else if (strcmp(intf, wp_viewporter_interface.name) == 0) {
+        self->m_viewporter = (wp_viewporter*)wl_registry_bind(reg, id, &wp_viewporter_interface, 1);
+    } else if (strcmp(intf, wp_fractional_scale_manager_v1_interface.name) == 0) {
+        self->m_fractionalScaleManager = (wp_fractional_scale_manager_v1*)wl_registry_bind(reg, id, &wp_fractional_scale_manager_v1_interface, 1);
+    } else if (strcmp(intf, wp_presentation_interface.name) == 0) {
+        self->m_presentation = (wp_presentation*)wl_registry_bind(reg, id, &wp_presentation_interface, 1);
+        wp_presentation_add_listener(self->m_presentation, &presentation_listener, self);
     }
 }
 
@@ -138,11 +293,96 @@ void Window::handle_seat_capabilities(void* data, struct wl_seat* seat, uint32_t
         self->m_keyboard = wl_seat_get_keyboard(seat);
         wl_keyboard_add_listener(self->m_keyboard, &keyboard_listener, self);
     }
+    if ((caps & WL_SEAT_CAPABILITY_POINTER) && !self->m_pointer) {
+        self->m_pointer = wl_seat_get_pointer(seat);
+        wl_pointer_add_listener(self->m_pointer, &pointer_listener, self);
+        if (self->m_relativePointerManager) {
+            // With the input thread running, create it through a manager wrapper bound to the input
+            // queue: a proxy moved after creation could have its first events dispatched on the wrong one
+            auto* manager = self->m_relativePointerManager;
+            if (self->m_inputQueue) {
+                manager = static_cast<zwp_relative_pointer_manager_v1*>(wl_proxy_create_wrapper(manager));
+                wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(manager), self->m_inputQueue);
+            }
+            self->m_relativePointer = zwp_relative_pointer_manager_v1_get_relative_pointer(manager, self->m_pointer);
+            if (manager != self->m_relativePointerManager) wl_proxy_wrapper_destroy(manager);
+            zwp_relative_pointer_v1_add_listener(self->m_relativePointer, &relative_pointer_listener, self);
+        }
+    }
+}
+
+void Window::handle_keyboard_key(void* data, struct wl_keyboard*, uint32_t, uint32_t time, uint32_t key, uint32_t state) {
+    auto* self = static_cast<Window*>(data);
+    if (self->m_onKey) self->m_onKey(KeyEvent{ key, state == WL_KEYBOARD_KEY_STATE_PRESSED, input_time_ms(time) });
 }
 
-void Window::handle_keyboard_key(void* data, struct wl_keyboard*, uint32_t, uint32_t, uint32_t key, uint32_t state) {
+void Window::handle_pointer_motion(void* data, struct wl_pointer*, uint32_t time, wl_fixed_t x, wl_fixed_t y) {
     auto* self = static_cast<Window*>(data);
-    if (self->m_onKey) self->m_onKey(key, state == WL_KEYBOARD_KEY_STATE_PRESSED);
+    if (self->m_onPointer) self->m_onPointer(PointerPositionEvent{ wl_fixed_to_double(x), wl_fixed_to_double(y), input_time_ms(time) });
+}
+
+void Window::handle_pointer_button(void* data, struct wl_pointer*, uint32_t, uint32_t time, uint32_t button, uint32_t state) {
+    auto* self = static_cast<Window*>(data);
+    if (self->m_onPointer) self->m_onPointer(PointerButtonEvent{ button, state == WL_POINTER_BUTTON_STATE_PRESSED, input_time_ms(time) });
+}
+
+void Window::handle_relative_motion(void* data, struct zwp_relative_pointer_v1*, uint32_t utimeHi, uint32_t utimeLo,
+                                    wl_fixed_t, wl_fixed_t, wl_fixed_t dxUnaccel, wl_fixed_t dyUnaccel) {
+    // Unaccelerated deltas: camera control wants raw device motion, not the desktop's cursor curve
+    auto* self = static_cast<Window*>(data);
+    if (self->m_onPointer) {
+        self->m_onPointer(PointerMotionEvent{ wl_fixed_to_double(dxUnaccel), wl_fixed_to_double(dyUnaccel), input_time_us(utimeHi, utimeLo) });
+    }
+}
+
+// --- Presentation feedback ---
+
+void Window::track_frame(uint64_t frameId, uint64_t inputTimeNs) {
+    if (!m_presentation) return;
+    auto& fb = m_feedback.emplace_back(std::make_unique<FrameFeedback>(FrameFeedback{
+        this, wp_presentation_feedback(m_presentation, m_surface), frameId, inputTimeNs }));
+    wp_presentation_feedback_add_listener(fb->feedback, &feedback_listener, fb.get());
+    m_lastTracked = fb.get();
+}
+
+void Window::handle_presentation_clock(void* data, struct wp_presentation*, uint32_t clockId) {
+    static_cast<Window*>(data)->m_presentationClock = clockId;
+}
+
+void Window::handle_feedback_presented(void* data, struct wp_presentation_feedback*, uint32_t secHi, uint32_t secLo, uint32_t nsec,
+                                       uint32_t, uint32_t, uint32_t, uint32_t) {
+    auto* fb = static_cast<FrameFeedback*>(data);
+    Window* self = fb->window;
+    self->m_framesPresented.add();
+    self->m_lastPresentedFrame = std::max(self->m_lastPresentedFrame, fb->frameId);
+
+    if (fb->inputTimeNs != 0) {
+        // 1. Presentation time is on the compositor's clock; move it onto ours if they differ
+        uint64_t presentedNs = ((uint64_t(secHi) << 32) | secLo) * 1'000'000'000 + nsec;
+        auto clock = static_cast<clockid_t>(self->m_presentationClock);
+        if (clock != CLOCK_MONOTONIC) presentedNs = presentedNs - clock_ns(clock) + clock_ns(CLOCK_MONOTONIC);
+
+        // 2. Input older than a second means a stale tag (or a bogus clock), not latency
+        if (presentedNs > fb->inputTimeNs && presentedNs - fb->inputTimeNs < 1'000'000'000) {
+            self->m_lastInputToPresentUs = (presentedNs - fb->inputTimeNs) / 1000;
+            self->m_inputToPresent.record(self->m_lastInputToPresentUs);
+        }
+    }
+    self->finish_feedback(fb);
+}
+
+void Window::handle_feedback_discarded(void* data, struct wp_presentation_feedback*) {
+    auto* fb = static_cast<FrameFeedback*>(data);
+    fb->window->m_framesDiscarded.add();
+    fb->window->finish_feedback(fb);
+}
+
+void Window::finish_feedback(FrameFeedback* fb) {
+    if (fb == m_lastTracked) m_lastTracked = nullptr;
+    wp_presentation_feedback_destroy(fb->feedback);
+    // Feedback completes in submission order, so this is almost always the front
+    auto it = std::find_if(m_feedback.begin(), m_feedback.end(), [fb](const auto& p) { return p.get() == fb; });
+    if (it != m_feedback.end()) m_feedback.erase(it);
 }
 
 void Window::handle_xdg_surface_configure(void* data, struct xdg_surface* surf, uint32_t serial) {
@@ -151,9 +391,85 @@ void Window::handle_xdg_surface_configure(void* data, struct xdg_surface* surf,
     wl_surface_commit(window->m_surface);
 }
 
-void Window::handle_xdg_toplevel_configure(void* data, struct xdg_toplevel*, int32_t w, int32_t h, struct wl_array*) {
+void Window::handle_xdg_toplevel_configure(void* data, struct xdg_toplevel*, int32_t w, int32_t h, struct wl_array* states) {
     auto* self = static_cast<Window*>(data);
-    if (w > 0 && h > 0 && self->m_onResize) self->m_onResize(w, h);
+
+    // 1. Every configure carries the full state set, so absence means "no longer suspended"
+    //    (wl_array_for_each does not compile as C++, hence the manual walk)
+    bool suspended = false;
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+    const auto* state = static_cast<const uint32_t*>(states->data);
+    for (size_t i = 0; i < states->size / sizeof(uint32_t); ++i) {
+        if (state[i] == XDG_TOPLEVEL_STATE_SUSPENDED) suspended = true;
+    }
+#else
+    (void)states;
+#endif
+    if (suspended != self->m_suspended) {
+        self->m_suspended = suspended;
+        std::println("window: {}", suspended ? "suspended" : "resumed");
+    }
+
+    // 2. 0x0 means "pick your own size": keep the current one
+    if (w > 0 && h > 0) {
+        self->m_logicalWidth = static_cast<uint32_t>(w);
+        self->m_logicalHeight = static_cast<uint32_t>(h);
+        self->update_buffer_size();
+    }
+}
+
+void Window::handle_preferred_scale(void* data, struct wp_fractional_scale_v1*, uint32_t scale) {
+    auto* self = static_cast<Window*>(data);
+    if (scale == 0 || scale == self->m_preferredScale120) return;
+    self->m_preferredScale120 = scale;
+    std::println("window: preferred scale {:.3f}", self->preferred_scale());
+    self->update_buffer_size();
+}
+
+void Window::set_render_scale(float scale) {
+    scale = std::clamp(scale, MIN_RENDER_SCALE, MAX_RENDER_SCALE);
+    if (scale == m_renderScale) return;
+    if (!m_viewport) std::println("window: no wp_viewporter, render scale {:.2f} has no effect", scale);
+    m_renderScale = scale;
+    update_buffer_size();
+}
+
+void Window::update_buffer_size() {
+    if (m_logicalWidth == 0 || m_logicalHeight == 0) return;
+
+    // 1. The viewport maps whatever buffer we attach onto the logical size; without one the
+    //    buffer has to be the logical size (buffer scale stays 1)
+    double scale = m_viewport ? preferred_scale() * m_renderScale : 1.0;
+    auto w = static_cast<uint32_t>(std::max(1L, std::lround(m_logicalWidth * scale)));
+    auto h = static_cast<uint32_t>(std::max(1L, std::lround(m_logicalHeight * scale)));
+    if (m_viewport) wp_viewport_set_destination(m_viewport, static_cast<int32_t>(m_logicalWidth), static_cast<int32_t>(m_logicalHeight));
+
+    // 2. Only a new buffer size needs a new swapchain; the destination applies on the next commit
+    if (w == m_physicalWidth && h == m_physicalHeight) return;
+    m_physicalWidth = w;
+    m_physicalHeight = h;
+    if (m_onResize) m_onResize(w, h);
+}
+
+void Window::request_frame() {
+    if (m_frameCallback) return;
+    m_frameCallback = wl_surface_frame(m_surface);
+    wl_callback_add_listener(m_frameCallback, &frame_listener, this);
+}
+
+void Window::cancel_frame() {
+    if (m_frameCallback) {
+        wl_callback_destroy(m_frameCallback);
+        m_frameCallback = nullptr;
+    }
+    // Feedback for a commit that never happened would only ever report the next frame as this one
+    if (m_lastTracked) finish_feedback(m_lastTracked);
+}
+
+void Window::handle_frame_done(void* data, struct wl_callback* cb, uint32_t) {
+    auto* self = static_cast<Window*>(data);
+    wl_callback_destroy(cb);
+    if (self->m_frameCallback == cb) self->m_frameCallback = nullptr;
 }
 
 void Window::handle_xdg_wm_base_ping(void*, struct xdg_wm_base* wm, uint32_t serial) {
@@ -162,9 +478,10 @@ void Window::handle_xdg_wm_base_ping(void*, struct xdg_wm_base* wm, uint32_t ser
 
 
 
-void Window::update(Zeta::Event e) {
-
-    auto arg = std::get<Zeta::KeyEvent>(e);
+void Window::update(const Zeta::CoreEvent& e) {
+    const auto* key = std::get_if<Zeta::KeyEvent>(&e);
+    if (!key) return;
+    const auto& arg = *key;
 
     if (arg.key == KEY_A && arg.pressed) { std::println("pressed {}", arg.key ); }
     else if (arg.key == KEY_B && arg.pressed) { std::println("pressed {}", arg.key ); }